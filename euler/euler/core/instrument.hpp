@@ -0,0 +1,504 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../simd/isa.hpp"
+
+// Set to 1 to record per kernel counters. Must be the same for every translation unit
+// of a program; when 0 the kernel scope macro expands to nothing and its arguments are
+// never evaluated. Each thread that records a kernel holds about 170 KB of counters
+// (mostly its event ring) while it runs; on exit they are folded into a retired total and
+// reused by the next thread, so memory grows with concurrent threads, not started ones.
+#ifndef EULER_ENABLE_INSTRUMENTATION
+#define EULER_ENABLE_INSTRUMENTATION 0
+#endif
+
+#define EULER_INSTRUMENT_CONCAT_IMPL(a, b) a##b
+#define EULER_INSTRUMENT_CONCAT(a, b) EULER_INSTRUMENT_CONCAT_IMPL(a, b)
+
+#if EULER_ENABLE_INSTRUMENTATION
+    // Time the rest of the enclosing block as one call of kernel `name`.
+    #define EULER_KERNEL_SCOPE(name, path, elements, bytes)                                             \
+        static const uint32_t EULER_INSTRUMENT_CONCAT(eulerKernelId_, __LINE__) =                      \
+            ::euler::instrument::registerKernel(name);                                                  \
+        const ::euler::instrument::kernelScope EULER_INSTRUMENT_CONCAT(eulerKernelScope_, __LINE__)(    \
+            EULER_INSTRUMENT_CONCAT(eulerKernelId_, __LINE__), path, elements, bytes)
+#else
+    #define EULER_KERNEL_SCOPE(name, path, elements, bytes) ((void)0)
+#endif
+
+namespace euler
+{
+namespace instrument
+{
+    constexpr bool kEnabled = EULER_ENABLE_INSTRUMENTATION != 0;
+
+    constexpr uint32_t kMaxKernels = 128;
+    constexpr uint32_t kMaxEventsPerThread = 4096;
+    constexpr uint32_t kIsaCount = static_cast<uint32_t>(isa::count);
+
+    inline uint64_t readCycles()
+    {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Totals of one kernel, summed over every thread that ran it.
+    struct kernelStats
+    {
+        std::string name;
+
+        uint64_t calls    = 0;
+        uint64_t elements = 0;
+        uint64_t bytes    = 0;
+        uint64_t cycles   = 0;
+
+        // Calls per dispatched path, indexed by isa.
+        uint64_t isaCalls[kIsaCount] = { };
+    };
+
+    // One recorded call, kept in a per thread ring of the last kMaxEventsPerThread calls.
+    struct kernelEvent
+    {
+        uint32_t kernel;
+        uint32_t thread;
+        isa path;
+
+        uint64_t start;
+        uint64_t cycles;
+        uint64_t elements;
+        uint64_t bytes;
+    };
+
+    struct snapshot
+    {
+        std::vector<kernelStats> kernels; // Indexed by kernel id.
+        std::vector<kernelEvent> events;  // Sorted by start.
+
+        double cyclesPerMicrosecond = 0.0;
+    };
+
+    namespace detail
+    {
+        // Counters owned by one thread. Only the owner writes them, so an update is a
+        // relaxed load and store without any locked instruction, while snapshots may read
+        // them concurrently without tearing.
+        struct threadCounters
+        {
+            struct eventSlot
+            {
+                std::atomic<uint64_t> kernelAndIsa;
+                std::atomic<uint64_t> start;
+                std::atomic<uint64_t> cycles;
+                std::atomic<uint64_t> elements;
+                std::atomic<uint64_t> bytes;
+            };
+
+            uint32_t thread = 0;
+
+            std::atomic<uint64_t> calls[kMaxKernels][kIsaCount];
+            std::atomic<uint64_t> elements[kMaxKernels];
+            std::atomic<uint64_t> bytes[kMaxKernels];
+            std::atomic<uint64_t> cycles[kMaxKernels];
+
+            eventSlot events[kMaxEventsPerThread];
+            std::atomic<uint64_t> eventCount;
+        };
+
+        // Totals of threads that have exited, guarded by the registry lock.
+        struct retiredCounters
+        {
+            uint64_t calls[kMaxKernels][kIsaCount] = { };
+            uint64_t elements[kMaxKernels] = { };
+            uint64_t bytes[kMaxKernels] = { };
+            uint64_t cycles[kMaxKernels] = { };
+        };
+
+        struct registry
+        {
+            std::mutex lock;
+
+            std::atomic<uint32_t> kernelCount { 0 };
+            std::atomic<const char*> names[kMaxKernels];
+
+            // Never shrinks. Counters of exited threads wait in idle for the next thread,
+            // their events stay visible to snapshots until it overwrites them.
+            std::vector<std::unique_ptr<threadCounters>> threads;
+            std::vector<threadCounters*> idle;
+
+            retiredCounters retired;
+        };
+
+        inline registry& getRegistry()
+        {
+            static registry instance;
+            return instance;
+        }
+
+        inline void add(std::atomic<uint64_t>& counter, uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        // Moves the totals of an exiting thread into the retired counters and hands its
+        // block to the next thread that records a kernel.
+        inline void retire(threadCounters& counters)
+        {
+            registry& reg = getRegistry();
+            std::lock_guard<std::mutex> guard(reg.lock);
+
+            for (uint32_t k = 0; k < kMaxKernels; k++)
+            {
+                for (uint32_t i = 0; i < kIsaCount; i++)
+                {
+                    reg.retired.calls[k][i] += counters.calls[k][i].exchange(0, std::memory_order_relaxed);
+                }
+                reg.retired.elements[k] += counters.elements[k].exchange(0, std::memory_order_relaxed);
+                reg.retired.bytes[k]    += counters.bytes[k].exchange(0, std::memory_order_relaxed);
+                reg.retired.cycles[k]   += counters.cycles[k].exchange(0, std::memory_order_relaxed);
+            }
+
+            reg.idle.push_back(&counters);
+        }
+
+        struct threadSlot
+        {
+            threadCounters* counters = nullptr;
+
+            ~threadSlot()
+            {
+                if (counters != nullptr)
+                {
+                    retire(*counters);
+                }
+            }
+        };
+
+        inline threadCounters& localCounters()
+        {
+            thread_local threadSlot slot;
+            if (slot.counters == nullptr)
+            {
+                registry& reg = getRegistry();
+                std::lock_guard<std::mutex> guard(reg.lock);
+
+                if (!reg.idle.empty())
+                {
+                    slot.counters = reg.idle.back();
+                    reg.idle.pop_back();
+                }
+                else
+                {
+                    reg.threads.push_back(std::make_unique<threadCounters>());
+                    slot.counters = reg.threads.back().get();
+                    slot.counters->thread = static_cast<uint32_t>(reg.threads.size() - 1);
+                }
+            }
+            return *slot.counters;
+        }
+
+        inline void record(uint32_t kernel, isa path, uint64_t elements, uint64_t bytes, uint64_t start, uint64_t cycles)
+        {
+            threadCounters& counters = localCounters();
+
+            add(counters.calls[kernel][static_cast<uint32_t>(path)], 1);
+            add(counters.elements[kernel], elements);
+            add(counters.bytes[kernel], bytes);
+            add(counters.cycles[kernel], cycles);
+
+            const uint64_t index = counters.eventCount.load(std::memory_order_relaxed);
+            threadCounters::eventSlot& slot = counters.events[index % kMaxEventsPerThread];
+
+            slot.kernelAndIsa.store((uint64_t(kernel) << 8) | uint64_t(path), std::memory_order_relaxed);
+            slot.start.store(start, std::memory_order_relaxed);
+            slot.cycles.store(cycles, std::memory_order_relaxed);
+            slot.elements.store(elements, std::memory_order_relaxed);
+            slot.bytes.store(bytes, std::memory_order_relaxed);
+
+            counters.eventCount.store(index + 1, std::memory_order_release);
+        }
+
+        inline void writeJsonString(std::ostream& out, const char* text)
+        {
+            out << '"';
+            for (; *text; ++text)
+            {
+                const char c = *text;
+                if (c == '"' || c == '\\')
+                {
+                    out << '\\' << c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    out << ' ';
+                }
+                else
+                {
+                    out << c;
+                }
+            }
+            out << '"';
+        }
+    }
+
+    // Returns a stable id for `name`, registering it on first use. Kernels past
+    // kMaxKernels - 1 share the last slot.
+    inline uint32_t registerKernel(const char* name)
+    {
+        detail::registry& reg = detail::getRegistry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+
+        const uint32_t count = reg.kernelCount.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (std::strcmp(reg.names[i].load(std::memory_order_relaxed), name) == 0)
+            {
+                return i;
+            }
+        }
+
+        if (count == kMaxKernels - 1)
+        {
+            reg.names[count].store("euler::overflow", std::memory_order_relaxed);
+            reg.kernelCount.store(kMaxKernels, std::memory_order_release);
+        }
+        if (count >= kMaxKernels - 1)
+        {
+            return kMaxKernels - 1;
+        }
+
+        reg.names[count].store(name, std::memory_order_relaxed);
+        reg.kernelCount.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+    class kernelScope
+    {
+    public:
+        explicit kernelScope(uint32_t kernel, isa path, uint64_t elements, uint64_t bytes)
+            : m_kernel(kernel), m_path(path), m_elements(elements), m_bytes(bytes), m_start(readCycles()) { }
+
+        ~kernelScope()
+        {
+            detail::record(m_kernel, m_path, m_elements, m_bytes, m_start, readCycles() - m_start);
+        }
+
+        kernelScope(const kernelScope&) = delete;
+        kernelScope& operator=(const kernelScope&) = delete;
+
+    private:
+        uint32_t m_kernel;
+        isa      m_path;
+        uint64_t m_elements;
+        uint64_t m_bytes;
+        uint64_t m_start;
+    };
+
+    // Measured once against the steady clock, about 10ms on first call.
+    inline double cyclesPerMicrosecond()
+    {
+        static const double value = []()
+        {
+            using clock = std::chrono::steady_clock;
+
+            const clock::time_point t0 = clock::now();
+            const uint64_t c0 = readCycles();
+
+            clock::time_point t1 = t0;
+            while (t1 - t0 < std::chrono::milliseconds(10))
+            {
+                t1 = clock::now();
+            }
+            const uint64_t c1 = readCycles();
+
+            const double us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+            return double(c1 - c0) / us;
+        }();
+
+        return value;
+    }
+
+    // Sums every thread's counters. Safe to call while kernels run, events recorded
+    // concurrently with the call may be missing or partially written.
+    inline snapshot takeSnapshot()
+    {
+        snapshot result;
+        result.cyclesPerMicrosecond = cyclesPerMicrosecond();
+
+        detail::registry& reg = detail::getRegistry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+
+        const uint32_t kernelCount = reg.kernelCount.load(std::memory_order_acquire);
+        result.kernels.resize(kernelCount);
+        for (uint32_t k = 0; k < kernelCount; k++)
+        {
+            kernelStats& stats = result.kernels[k];
+            stats.name = reg.names[k].load(std::memory_order_relaxed);
+
+            for (uint32_t i = 0; i < kIsaCount; i++)
+            {
+                stats.isaCalls[i] += reg.retired.calls[k][i];
+                stats.calls += reg.retired.calls[k][i];
+            }
+            stats.elements += reg.retired.elements[k];
+            stats.bytes    += reg.retired.bytes[k];
+            stats.cycles   += reg.retired.cycles[k];
+        }
+
+        for (const std::unique_ptr<detail::threadCounters>& counters : reg.threads)
+        {
+            for (uint32_t k = 0; k < kernelCount; k++)
+            {
+                kernelStats& stats = result.kernels[k];
+                for (uint32_t i = 0; i < kIsaCount; i++)
+                {
+                    const uint64_t calls = counters->calls[k][i].load(std::memory_order_relaxed);
+                    stats.isaCalls[i] += calls;
+                    stats.calls += calls;
+                }
+                stats.elements += counters->elements[k].load(std::memory_order_relaxed);
+                stats.bytes    += counters->bytes[k].load(std::memory_order_relaxed);
+                stats.cycles   += counters->cycles[k].load(std::memory_order_relaxed);
+            }
+
+            const uint64_t eventCount = counters->eventCount.load(std::memory_order_acquire);
+            const uint64_t first = eventCount > kMaxEventsPerThread ? eventCount - kMaxEventsPerThread : 0;
+            for (uint64_t e = first; e < eventCount; e++)
+            {
+                const detail::threadCounters::eventSlot& slot = counters->events[e % kMaxEventsPerThread];
+                const uint64_t kernelAndIsa = slot.kernelAndIsa.load(std::memory_order_relaxed);
+
+                kernelEvent event;
+                event.kernel   = static_cast<uint32_t>(kernelAndIsa >> 8);
+                event.thread   = counters->thread;
+                event.path     = static_cast<isa>(kernelAndIsa & 0xff);
+                event.start    = slot.start.load(std::memory_order_relaxed);
+                event.cycles   = slot.cycles.load(std::memory_order_relaxed);
+                event.elements = slot.elements.load(std::memory_order_relaxed);
+                event.bytes    = slot.bytes.load(std::memory_order_relaxed);
+
+                if (event.kernel < kernelCount)
+                {
+                    result.events.push_back(event);
+                }
+            }
+        }
+
+        std::sort(result.events.begin(), result.events.end(),
+            [](const kernelEvent& a, const kernelEvent& b) { return a.start < b.start; });
+
+        return result;
+    }
+
+    // Clears all counters and events. Call while no instrumented kernel is running.
+    inline void reset()
+    {
+        detail::registry& reg = detail::getRegistry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+
+        reg.retired = detail::retiredCounters();
+        for (const std::unique_ptr<detail::threadCounters>& counters : reg.threads)
+        {
+            for (uint32_t k = 0; k < kMaxKernels; k++)
+            {
+                for (uint32_t i = 0; i < kIsaCount; i++)
+                {
+                    counters->calls[k][i].store(0, std::memory_order_relaxed);
+                }
+                counters->elements[k].store(0, std::memory_order_relaxed);
+                counters->bytes[k].store(0, std::memory_order_relaxed);
+                counters->cycles[k].store(0, std::memory_order_relaxed);
+            }
+            counters->eventCount.store(0, std::memory_order_release);
+        }
+    }
+
+    // Writes the snapshot events in Chrome trace event format (chrome://tracing, Perfetto).
+    inline void exportChromeTrace(const snapshot& snap, std::ostream& out)
+    {
+        const double cyclesPerUs = snap.cyclesPerMicrosecond > 0.0 ? snap.cyclesPerMicrosecond : 1.0;
+        const uint64_t origin = snap.events.empty() ? 0 : snap.events.front().start;
+
+        // Fixed notation keeps nanosecond resolution however long the trace runs.
+        const std::ios_base::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(3);
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+        bool first = true;
+        for (const kernelEvent& event : snap.events)
+        {
+            out << (first ? "" : ",") << "\n{\"name\":";
+            detail::writeJsonString(out, snap.kernels[event.kernel].name.c_str());
+            out << ",\"cat\":\"euler\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+                << ",\"ts\":" << double(event.start - origin) / cyclesPerUs
+                << ",\"dur\":" << double(event.cycles) / cyclesPerUs
+                << ",\"args\":{\"elements\":" << event.elements
+                << ",\"bytes\":" << event.bytes
+                << ",\"cycles\":" << event.cycles
+                << ",\"isa\":\"" << isaName(event.path) << "\"}}";
+            first = false;
+        }
+
+        out << "\n],\"otherData\":{\"kernels\":[";
+
+        first = true;
+        for (const kernelStats& stats : snap.kernels)
+        {
+            out << (first ? "" : ",") << "\n{\"name\":";
+            detail::writeJsonString(out, stats.name.c_str());
+            out << ",\"calls\":" << stats.calls
+                << ",\"elements\":" << stats.elements
+                << ",\"bytes\":" << stats.bytes
+                << ",\"cycles\":" << stats.cycles;
+            for (uint32_t i = 0; i < kIsaCount; i++)
+            {
+                if (stats.isaCalls[i] != 0)
+                {
+                    out << ",\"" << isaName(static_cast<isa>(i)) << "\":" << stats.isaCalls[i];
+                }
+            }
+            out << "}";
+            first = false;
+        }
+
+        out << "\n]}}\n";
+
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    inline bool writeChromeTrace(const snapshot& snap, const char* path)
+    {
+        std::ofstream file(path, std::ios::out | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        exportChromeTrace(snap, file);
+        return static_cast<bool>(file);
+    }
+}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace euler
+{
+    // Worker count for a `threadCount` argument, 0 means every hardware thread.
+    inline uint32_t resolveThreadCount(uint32_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        return threadCount;
+    }
+
+    // Splits [0, count) into contiguous chunks of at least `grain` elements, chunk
+    // boundaries aligned to `grain`, and calls fn(begin, end) once per chunk. The
+    // calling thread takes the first chunk, so a single chunk never spawns a thread.
+    template<typename Fn>
+    inline void parallelFor(size_t count, size_t grain, uint32_t threadCount, Fn&& fn)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        grain = std::max<size_t>(grain, 1);
+
+        const size_t maxChunks = (count + grain - 1) / grain;
+        const size_t chunks = std::min<size_t>(resolveThreadCount(threadCount), maxChunks);
+        if (chunks <= 1)
+        {
+            fn(size_t(0), count);
+            return;
+        }
+
+        // Whole grains per chunk, the remainder spread over the first chunks.
+        const size_t grains = maxChunks / chunks;
+        const size_t extra  = maxChunks % chunks;
+
+        std::vector<std::thread> workers;
+        workers.reserve(chunks - 1);
+
+        size_t firstEnd = 0;
+        size_t begin = 0;
+        for (size_t c = 0; c < chunks; c++)
+        {
+            const size_t end = std::min(count, begin + (grains + (c < extra ? 1 : 0)) * grain);
+            if (c == 0)
+            {
+                firstEnd = end;
+            }
+            else
+            {
+                workers.emplace_back([&fn, begin, end]() { fn(begin, end); });
+            }
+            begin = end;
+        }
+
+        fn(size_t(0), firstEnd);
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "../scalar/tvec3.hpp"
+#include "../scalar/tvec4.hpp"
+
+namespace euler
+{
+    // Structure of arrays view over vec3 components, each span holds one component
+    // of every element. T may be const qualified for read only streams.
+    template<typename T>
+    class tsoa3
+    {
+    public:
+        using value = std::remove_const_t<T>;
+
+        explicit tsoa3() = default;
+        explicit tsoa3(std::span<T> x, std::span<T> y, std::span<T> z) : m_x(x), m_y(y), m_z(z) { }
+
+        // Read only view from a mutable one.
+        template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+        tsoa3(const tsoa3<U>& soa) : m_x(soa.x()), m_y(soa.y()), m_z(soa.z()) { }
+
+        inline size_t size() const { return m_x.size(); }
+
+        inline std::span<T> x() const { return m_x; }
+        inline std::span<T> y() const { return m_y; }
+        inline std::span<T> z() const { return m_z; }
+
+        inline tvec3<value> get(size_t index) const { return tvec3<value>(m_x[index], m_y[index], m_z[index]); }
+
+        inline void set(size_t index, const tvec3<value>& v) const
+        {
+            m_x[index] = v.getX();
+            m_y[index] = v.getY();
+            m_z[index] = v.getZ();
+        }
+
+        inline tsoa3 subspan(size_t offset, size_t count) const
+        {
+            return tsoa3(m_x.subspan(offset, count), m_y.subspan(offset, count), m_z.subspan(offset, count));
+        }
+
+    private:
+        std::span<T> m_x, m_y, m_z;
+    };
+
+    template<typename T>
+    class tsoa4
+    {
+    public:
+        using value = std::remove_const_t<T>;
+
+        explicit tsoa4() = default;
+        explicit tsoa4(std::span<T> x, std::span<T> y, std::span<T> z, std::span<T> w) : m_x(x), m_y(y), m_z(z), m_w(w) { }
+
+        template<typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+        tsoa4(const tsoa4<U>& soa) : m_x(soa.x()), m_y(soa.y()), m_z(soa.z()), m_w(soa.w()) { }
+
+        inline size_t size() const { return m_x.size(); }
+
+        inline std::span<T> x() const { return m_x; }
+        inline std::span<T> y() const { return m_y; }
+        inline std::span<T> z() const { return m_z; }
+        inline std::span<T> w() const { return m_w; }
+
+        inline tvec4<value> get(size_t index) const
+        {
+            return tvec4<value>(m_x[index], m_y[index], m_z[index], m_w[index]);
+        }
+
+        inline void set(size_t index, const tvec4<value>& v) const
+        {
+            m_x[index] = v.getX();
+            m_y[index] = v.getY();
+            m_z[index] = v.getZ();
+            m_w[index] = v.getW();
+        }
+
+        inline tsoa4 subspan(size_t offset, size_t count) const
+        {
+            return tsoa4(
+                m_x.subspan(offset, count),
+                m_y.subspan(offset, count),
+                m_z.subspan(offset, count),
+                m_w.subspan(offset, count));
+        }
+
+    private:
+        std::span<T> m_x, m_y, m_z, m_w;
+    };
+
+    // Final export class.
+    using soa3f  = tsoa3<float>;
+    using csoa3f = tsoa3<const float>;
+    using soa4f  = tsoa4<float>;
+    using csoa4f = tsoa4<const float>;
+}
@@ -2,4 +2,20 @@
 
 #include "scalar/tvec2.hpp"
 #include "scalar/tvec3.hpp"
-#include "scalar/tvec4.hpp"
\ No newline at end of file
+#include "scalar/tvec4.hpp"
+
+#include "core/instrument.hpp"
+#include "core/soa.hpp"
+#include "core/parallel.hpp"
+
+#include "simd/vfloat4.hpp"
+#include "simd/vfloat8.hpp"
+
+#include "geometry/curve.hpp"
+#include "geometry/intersect.hpp"
+#include "geometry/mesh.hpp"
+
+#include "sampling/random.hpp"
+#include "sampling/sampler.hpp"
+
+#include "physics/particle.hpp"
\ No newline at end of file
@@ -0,0 +1,490 @@
+#pragma once
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include "../scalar/tvec3.hpp"
+#include "../scalar/tvec4.hpp"
+#include "../simd/vfloat4.hpp"
+#include "../core/soa.hpp"
+#include "../core/instrument.hpp"
+
+namespace euler
+{
+    // Cubic segment bases. Every segment is weighted from four control values:
+    //   bezier     p0, p1, p2, p3, passes through p0 and p3.
+    //   hermite    p0, m0, p1, m1, points and tangents.
+    //   catmullRom p0, p1, p2, p3, uniform, passes through p1 and p2.
+    //   bspline    p0, p1, p2, p3, uniform, C2 and approximating.
+    enum class curveBasis
+    {
+        bezier,
+        hermite,
+        catmullRom,
+        bspline,
+    };
+
+    // Control values a piecewise curve advances per segment.
+    template<curveBasis basis>
+    constexpr uint32_t curveStride()
+    {
+        return basis == curveBasis::bezier ? 3 : (basis == curveBasis::hermite ? 2 : 1);
+    }
+
+    template<curveBasis basis>
+    inline uint32_t curveSegmentCount(size_t controlCount)
+    {
+        return controlCount < 4 ? 0 : static_cast<uint32_t>((controlCount - 4) / curveStride<basis>() + 1);
+    }
+
+    // T is float, double or a lane type such as vfloat4.
+    template<curveBasis basis, typename T>
+    inline void cubicWeights(const T& t, T (&w)[4])
+    {
+        const T one(1.0f);
+        const T t2 = t * t;
+        const T t3 = t2 * t;
+
+        if constexpr (basis == curveBasis::bezier)
+        {
+            const T s  = one - t;
+            const T s2 = s * s;
+
+            w[0] = s2 * s;
+            w[1] = T(3.0f) * s2 * t;
+            w[2] = T(3.0f) * s * t2;
+            w[3] = t3;
+        }
+        else if constexpr (basis == curveBasis::hermite)
+        {
+            w[0] = T(2.0f) * t3 - T(3.0f) * t2 + one;
+            w[1] = t3 - T(2.0f) * t2 + t;
+            w[2] = T(3.0f) * t2 - T(2.0f) * t3;
+            w[3] = t3 - t2;
+        }
+        else if constexpr (basis == curveBasis::catmullRom)
+        {
+            const T half(0.5f);
+
+            w[0] = half * (T(2.0f) * t2 - t3 - t);
+            w[1] = half * (T(3.0f) * t3 - T(5.0f) * t2 + T(2.0f));
+            w[2] = half * (T(4.0f) * t2 - T(3.0f) * t3 + t);
+            w[3] = half * (t3 - t2);
+        }
+        else
+        {
+            const T sixth(1.0f / 6.0f);
+            const T s = one - t;
+
+            w[0] = sixth * s * s * s;
+            w[1] = sixth * (T(3.0f) * t3 - T(6.0f) * t2 + T(4.0f));
+            w[2] = sixth * (T(3.0f) * (t2 - t3 + t) + one);
+            w[3] = sixth * t3;
+        }
+    }
+
+    // One cubic segment at t in [0, 1].
+    template<curveBasis basis, typename V, typename T>
+    inline V evaluateSegment(const V& p0, const V& p1, const V& p2, const V& p3, T t)
+    {
+        T w[4];
+        cubicWeights<basis>(t, w);
+
+        return p0 * w[0] + p1 * w[1] + p2 * w[2] + p3 * w[3];
+    }
+
+    // Piecewise curve at global parameter u in [0, segmentCount]. Outside that range the
+    // first or last segment is used and the position extrapolates along its cubic.
+    template<curveBasis basis, typename V, typename T>
+    inline V evaluateCurve(std::span<const V> points, T u)
+    {
+        const uint32_t segments = curveSegmentCount<basis>(points.size());
+        assert(segments > 0 && "Curve needs at least 4 control values!");
+
+        // NaN falls into segment 0 like the SIMD path, never into an out of range cast.
+        const T floored = std::floor(u);
+        const T segment = !(floored > T(0)) ? T(0) : std::min(floored, T(segments - 1));
+        const size_t base = static_cast<size_t>(segment) * curveStride<basis>();
+
+        return evaluateSegment<basis>(points[base], points[base + 1], points[base + 2], points[base + 3], u - segment);
+    }
+
+    // Bezier curve of any degree (up to 31) by de Casteljau.
+    template<typename V, typename T>
+    inline V bezier(std::span<const V> points, T t)
+    {
+        constexpr size_t kMaxPoints = 32;
+        assert(!points.empty() && points.size() <= kMaxPoints && "Bezier degree over 31!");
+
+        V buffer[kMaxPoints];
+        std::copy(points.begin(), points.end(), buffer);
+
+        const T s = T(1) - t;
+        for (size_t n = points.size() - 1; n > 0; n--)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                buffer[i] = buffer[i] * s + buffer[i + 1] * t;
+            }
+        }
+        return buffer[0];
+    }
+
+    namespace detail
+    {
+        inline __m128 loadPoint(const tvec3<float>& p) { return _mm_setr_ps(p.getX(), p.getY(), p.getZ(), 0.0f); }
+        inline __m128 loadPoint(const tvec4<float>& p) { return _mm_setr_ps(p.getX(), p.getY(), p.getZ(), p.getW()); }
+
+        inline void storePoint(tvec3<float>& p, __m128 v)
+        {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, v);
+            p = tvec3<float>(lanes[0], lanes[1], lanes[2]);
+        }
+
+        inline void storePoint(tvec4<float>& p, __m128 v)
+        {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, v);
+            p = tvec4<float>(lanes[0], lanes[1], lanes[2], lanes[3]);
+        }
+
+        // Four parameters at a time: the weights are computed across lanes, then each
+        // lane's segment is accumulated with the point components in one register.
+        template<curveBasis basis, typename V>
+        inline void evaluateCurve(std::span<const V> points, std::span<const float> u, std::span<V> out)
+        {
+            constexpr uint32_t stride = curveStride<basis>();
+
+            const uint32_t segments = curveSegmentCount<basis>(points.size());
+            assert(segments > 0 && "Curve needs at least 4 control values!");
+            assert(out.size() >= u.size());
+
+            const vfloat4 lastSegment(float(segments - 1));
+            const size_t count = u.size();
+
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const vfloat4 params = vfloat4::load(&u[i]);
+                const vfloat4 segment = min(max(floor(params), vfloat4::zero()), lastSegment);
+
+                vfloat4 w[4];
+                cubicWeights<basis>(params - segment, w);
+
+                alignas(16) int32_t base[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(base), _mm_cvttps_epi32(segment.get()));
+
+                const __m128 lanes[4][4] =
+                {
+                    { _mm_shuffle_ps(w[0].get(), w[0].get(), 0x00), _mm_shuffle_ps(w[1].get(), w[1].get(), 0x00),
+                      _mm_shuffle_ps(w[2].get(), w[2].get(), 0x00), _mm_shuffle_ps(w[3].get(), w[3].get(), 0x00) },
+                    { _mm_shuffle_ps(w[0].get(), w[0].get(), 0x55), _mm_shuffle_ps(w[1].get(), w[1].get(), 0x55),
+                      _mm_shuffle_ps(w[2].get(), w[2].get(), 0x55), _mm_shuffle_ps(w[3].get(), w[3].get(), 0x55) },
+                    { _mm_shuffle_ps(w[0].get(), w[0].get(), 0xaa), _mm_shuffle_ps(w[1].get(), w[1].get(), 0xaa),
+                      _mm_shuffle_ps(w[2].get(), w[2].get(), 0xaa), _mm_shuffle_ps(w[3].get(), w[3].get(), 0xaa) },
+                    { _mm_shuffle_ps(w[0].get(), w[0].get(), 0xff), _mm_shuffle_ps(w[1].get(), w[1].get(), 0xff),
+                      _mm_shuffle_ps(w[2].get(), w[2].get(), 0xff), _mm_shuffle_ps(w[3].get(), w[3].get(), 0xff) },
+                };
+
+                for (int32_t l = 0; l < 4; l++)
+                {
+                    const V* p = &points[size_t(base[l]) * stride];
+
+                    __m128 acc = _mm_mul_ps(loadPoint(p[0]), lanes[l][0]);
+                    acc = _mm_add_ps(acc, _mm_mul_ps(loadPoint(p[1]), lanes[l][1]));
+                    acc = _mm_add_ps(acc, _mm_mul_ps(loadPoint(p[2]), lanes[l][2]));
+                    acc = _mm_add_ps(acc, _mm_mul_ps(loadPoint(p[3]), lanes[l][3]));
+
+                    storePoint(out[i + l], acc);
+                }
+            }
+
+            for (; i < count; i++)
+            {
+                out[i] = euler::evaluateCurve<basis>(points, u[i]);
+            }
+        }
+
+        // `components` streams per control value, out[c] = sum of w[k] * in[k][c].
+        template<curveBasis basis, size_t components>
+        inline void evaluateStreams(
+            const float* const (&in)[4][components],
+            float* const (&out)[components],
+            const float* t,
+            float uniformT,
+            size_t count)
+        {
+            vfloat4 uniformW[4];
+            cubicWeights<basis>(vfloat4(uniformT), uniformW);
+
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                vfloat4 perCurveW[4];
+                if (t != nullptr)
+                {
+                    cubicWeights<basis>(vfloat4::load(t + i), perCurveW);
+                }
+                const vfloat4 (&w)[4] = t != nullptr ? perCurveW : uniformW;
+
+                for (size_t c = 0; c < components; c++)
+                {
+                    vfloat4 acc = vfloat4::load(in[0][c] + i) * w[0];
+                    acc = madd(vfloat4::load(in[1][c] + i), w[1], acc);
+                    acc = madd(vfloat4::load(in[2][c] + i), w[2], acc);
+                    acc = madd(vfloat4::load(in[3][c] + i), w[3], acc);
+                    acc.store(out[c] + i);
+                }
+            }
+
+            for (; i < count; i++)
+            {
+                float w[4];
+                cubicWeights<basis>(t != nullptr ? t[i] : uniformT, w);
+
+                for (size_t c = 0; c < components; c++)
+                {
+                    out[c][i] = in[0][c][i] * w[0] + in[1][c][i] * w[1] + in[2][c][i] * w[2] + in[3][c][i] * w[3];
+                }
+            }
+        }
+
+        template<curveBasis basis>
+        inline void evaluateSegments(std::span<const csoa3f, 4> controls, const float* t, float uniformT, const soa3f& out)
+        {
+            const size_t count = out.size();
+            for (const csoa3f& control : controls)
+            {
+                assert(control.size() >= count);
+            }
+
+            const float* const in[4][3] =
+            {
+                { controls[0].x().data(), controls[0].y().data(), controls[0].z().data() },
+                { controls[1].x().data(), controls[1].y().data(), controls[1].z().data() },
+                { controls[2].x().data(), controls[2].y().data(), controls[2].z().data() },
+                { controls[3].x().data(), controls[3].y().data(), controls[3].z().data() },
+            };
+            float* const dst[3] = { out.x().data(), out.y().data(), out.z().data() };
+
+            evaluateStreams<basis>(in, dst, t, uniformT, count);
+        }
+
+        template<curveBasis basis>
+        inline void evaluateSegments(std::span<const csoa4f, 4> controls, const float* t, float uniformT, const soa4f& out)
+        {
+            const size_t count = out.size();
+            for (const csoa4f& control : controls)
+            {
+                assert(control.size() >= count);
+            }
+
+            const float* const in[4][4] =
+            {
+                { controls[0].x().data(), controls[0].y().data(), controls[0].z().data(), controls[0].w().data() },
+                { controls[1].x().data(), controls[1].y().data(), controls[1].z().data(), controls[1].w().data() },
+                { controls[2].x().data(), controls[2].y().data(), controls[2].z().data(), controls[2].w().data() },
+                { controls[3].x().data(), controls[3].y().data(), controls[3].z().data(), controls[3].w().data() },
+            };
+            float* const dst[4] = { out.x().data(), out.y().data(), out.z().data(), out.w().data() };
+
+            evaluateStreams<basis>(in, dst, t, uniformT, count);
+        }
+    }
+
+    // One piecewise curve at every parameter of `u`, out[i] = curve(u[i]).
+    template<curveBasis basis>
+    inline void evaluateCurve(std::span<const tvec3<float>> points, std::span<const float> u, std::span<tvec3<float>> out)
+    {
+        EULER_KERNEL_SCOPE("curve::evaluateCurve3", vfloat4::kPath, u.size(), u.size() * (sizeof(float) + sizeof(tvec3<float>)));
+        detail::evaluateCurve<basis>(points, u, out);
+    }
+
+    template<curveBasis basis>
+    inline void evaluateCurve(std::span<const tvec4<float>> points, std::span<const float> u, std::span<tvec4<float>> out)
+    {
+        EULER_KERNEL_SCOPE("curve::evaluateCurve4", vfloat4::kPath, u.size(), u.size() * (sizeof(float) + sizeof(tvec4<float>)));
+        detail::evaluateCurve<basis>(points, u, out);
+    }
+
+    // Many single segment curves at one parameter. controls[k] holds control value k
+    // of every curve, out.size() curves are evaluated.
+    template<curveBasis basis>
+    inline void evaluateSegments(std::span<const csoa3f, 4> controls, float t, const soa3f& out)
+    {
+        EULER_KERNEL_SCOPE("curve::evaluateSegments3", vfloat4::kPath, out.size(), out.size() * sizeof(float) * 15);
+        detail::evaluateSegments<basis>(controls, nullptr, t, out);
+    }
+
+    template<curveBasis basis>
+    inline void evaluateSegments(std::span<const csoa4f, 4> controls, float t, const soa4f& out)
+    {
+        EULER_KERNEL_SCOPE("curve::evaluateSegments4", vfloat4::kPath, out.size(), out.size() * sizeof(float) * 20);
+        detail::evaluateSegments<basis>(controls, nullptr, t, out);
+    }
+
+    // Many single segment curves, curve i at its own parameter t[i].
+    template<curveBasis basis>
+    inline void evaluateSegments(std::span<const csoa3f, 4> controls, std::span<const float> t, const soa3f& out)
+    {
+        assert(t.size() >= out.size());
+
+        EULER_KERNEL_SCOPE("curve::evaluateSegments3", vfloat4::kPath, out.size(), out.size() * sizeof(float) * 16);
+        detail::evaluateSegments<basis>(controls, t.data(), 0.0f, out);
+    }
+
+    template<curveBasis basis>
+    inline void evaluateSegments(std::span<const csoa4f, 4> controls, std::span<const float> t, const soa4f& out)
+    {
+        assert(t.size() >= out.size());
+
+        EULER_KERNEL_SCOPE("curve::evaluateSegments4", vfloat4::kPath, out.size(), out.size() * sizeof(float) * 21);
+        detail::evaluateSegments<basis>(controls, t.data(), 0.0f, out);
+    }
+
+    // Cumulative arc length of a piecewise curve sampled `samplesPerSegment` times per
+    // segment, mapping distance along the curve back to the curve parameter. Segments
+    // are measured lazily, only as far as queries reach, and stay cached until the
+    // control points from that segment on are invalidated.
+    template<curveBasis basis, typename V>
+    class tarcLengthTable
+    {
+    public:
+        explicit tarcLengthTable(std::span<const V> points, uint32_t samplesPerSegment = 16)
+            : m_points(points), m_samplesPerSegment(std::max(samplesPerSegment, 1u))
+        {
+            m_lengths.push_back(0.0f);
+        }
+
+        inline uint32_t getSegmentCount() const { return curveSegmentCount<basis>(m_points.size()); }
+        inline uint32_t getMeasuredSegmentCount() const { return m_measuredSegments; }
+        inline uint32_t getSamplesPerSegment() const { return m_samplesPerSegment; }
+
+        // Point the table at edited or appended control points; cached lengths of the
+        // segments before `firstChangedSegment` are kept.
+        inline void setPoints(std::span<const V> points, uint32_t firstChangedSegment)
+        {
+            m_points = points;
+            invalidate(firstChangedSegment);
+        }
+
+        inline void invalidate(uint32_t firstChangedSegment)
+        {
+            // Segments past the end of shrunk points are gone as well.
+            firstChangedSegment = std::min(firstChangedSegment, getSegmentCount());
+            if (firstChangedSegment < m_measuredSegments)
+            {
+                m_measuredSegments = firstChangedSegment;
+                m_lengths.resize(size_t(firstChangedSegment) * m_samplesPerSegment + 1);
+            }
+        }
+
+        inline float totalLength()
+        {
+            measureUntil(getSegmentCount());
+            return m_lengths.back();
+        }
+
+        // Curve parameter u in [0, segmentCount] at `distance` along the curve.
+        inline float parameterAt(float distance)
+        {
+            while (m_measuredSegments < getSegmentCount() && m_lengths.back() < distance)
+            {
+                measureUntil(m_measuredSegments + 1);
+            }
+            return lookup(distance);
+        }
+
+        inline void parametersAt(std::span<const float> distances, std::span<float> u)
+        {
+            assert(u.size() >= distances.size());
+
+            float farthest = 0.0f;
+            for (float d : distances)
+            {
+                farthest = std::max(farthest, d);
+            }
+            parameterAt(farthest);
+
+            EULER_KERNEL_SCOPE("curve::arcLengthLookup", isa::scalar, distances.size(), distances.size() * sizeof(float) * 2);
+            for (size_t i = 0; i < distances.size(); i++)
+            {
+                u[i] = lookup(distances[i]);
+            }
+        }
+
+    private:
+        inline void measureUntil(uint32_t segmentEnd)
+        {
+            if (segmentEnd <= m_measuredSegments)
+            {
+                return;
+            }
+
+            const uint32_t samples = m_samplesPerSegment;
+            const float step = 1.0f / float(samples);
+
+            std::vector<float> u(size_t(samples) + 1);
+            std::vector<V> positions(u.size());
+
+            for (uint32_t segment = m_measuredSegments; segment < segmentEnd; segment++)
+            {
+                for (uint32_t s = 0; s <= samples; s++)
+                {
+                    u[s] = float(segment) + float(s) * step;
+                }
+                // Last sample sits exactly on the next segment start, keep it in this one.
+                u[samples] = float(segment) + 1.0f;
+
+                detail::evaluateCurve<basis>(m_points, u, std::span<V>(positions));
+
+                float length = m_lengths.back();
+                for (uint32_t s = 1; s <= samples; s++)
+                {
+                    length += std::sqrt(lengthSquare(positions[s] - positions[s - 1]));
+                    m_lengths.push_back(length);
+                }
+            }
+
+            m_measuredSegments = segmentEnd;
+        }
+
+        inline float lookup(float distance) const
+        {
+            // NaN maps to the start, never past the end of the table.
+            const size_t last = m_lengths.size() - 1;
+            if (last == 0 || !(distance > 0.0f))
+            {
+                return 0.0f;
+            }
+            if (distance >= m_lengths[last])
+            {
+                return float(last) / float(m_samplesPerSegment);
+            }
+
+            const size_t hi = std::upper_bound(m_lengths.begin(), m_lengths.end(), distance) - m_lengths.begin();
+            const size_t lo = hi - 1;
+
+            const float span = m_lengths[hi] - m_lengths[lo];
+            const float f = span > 0.0f ? (distance - m_lengths[lo]) / span : 0.0f;
+
+            return (float(lo) + f) / float(m_samplesPerSegment);
+        }
+
+    private:
+        std::span<const V> m_points;
+        uint32_t m_samplesPerSegment;
+        uint32_t m_measuredSegments = 0;
+
+        // Cumulative length at every sample of the measured segments.
+        std::vector<float> m_lengths;
+    };
+
+    // Final export class.
+    template<curveBasis basis> using arcLengthTable3f = tarcLengthTable<basis, tvec3<float>>;
+    template<curveBasis basis> using arcLengthTable4f = tarcLengthTable<basis, tvec4<float>>;
+}
@@ -0,0 +1,622 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <span>
+#include <vector>
+
+#include "../scalar/tvec3.hpp"
+#include "../simd/vfloat4.hpp"
+#include "../simd/vfloat8.hpp"
+#include "../core/soa.hpp"
+#include "../core/parallel.hpp"
+#include "../core/instrument.hpp"
+
+namespace euler
+{
+    // Ray, sphere and plane intersection in single, packet (four or eight rays in lanes)
+    // and SoA stream form. Triangles use the Plucker coordinate test: each edge is
+    // reduced to six numbers computed from its lexicographically smaller vertex, so two
+    // triangles sharing an edge see exactly opposite edge terms and a ray crossing the
+    // edge can not slip between them. Edges count as inside, the test is two sided.
+
+    constexpr uint32_t kMissPrimitive = 0xffffffffu;
+
+    class ray
+    {
+    public:
+        explicit ray() = default;
+        explicit ray(const vec3f& origin, const vec3f& direction, float tMin = 0.0f, float tMax = FLT_MAX)
+            : m_origin(origin), m_direction(direction), m_tMin(tMin), m_tMax(tMax) { }
+
+        inline const vec3f& getOrigin() const { return m_origin; }
+        inline const vec3f& getDirection() const { return m_direction; }
+        inline float getTMin() const { return m_tMin; }
+        inline float getTMax() const { return m_tMax; }
+
+        inline ray& setTMax(float t) { m_tMax = t; return *this; }
+
+        inline vec3f at(float t) const { return m_origin + m_direction * t; }
+
+    private:
+        vec3f m_origin;
+        vec3f m_direction;
+        float m_tMin;
+        float m_tMax;
+    };
+
+    // Closest hit, P = (1 - u - v) * v0 + u * v1 + v * v2 for triangles.
+    struct rayHit
+    {
+        float t = FLT_MAX;
+        float u = 0.0f;
+        float v = 0.0f;
+        uint32_t primitive = kMissPrimitive;
+
+        inline bool isHit() const { return primitive != kMissPrimitive; }
+    };
+
+    // Triangle edge a -> b as Plucker direction (0..2) and moment (3..5).
+    inline void pluckerEdge(const vec3f& a, const vec3f& b, float (&out)[6])
+    {
+        const bool flip =
+            b.getX() < a.getX() || (b.getX() == a.getX() && (b.getY() < a.getY() || (b.getY() == a.getY() && b.getZ() < a.getZ())));
+
+        const vec3f& p = flip ? b : a;
+        const vec3f& q = flip ? a : b;
+
+        // Float products are exact in double, so the moment rounds the same way whether
+        // or not the compiler contracts this call site into fma.
+        const vec3f direction = q - p;
+        const tvec3<double> moment = cross(tvec3<double>(p.getX(), p.getY(), p.getZ()), tvec3<double>(q.getX(), q.getY(), q.getZ()));
+
+        const float sign = flip ? -1.0f : 1.0f;
+        for (int32_t i = 0; i < 3; i++)
+        {
+            out[i] = direction[i] * sign;
+            out[i + 3] = float(moment[i]) * sign;
+        }
+    }
+
+    // Triangle v0, v1, v2 in the form the intersection kernels read: the edges opposite
+    // v0, v1 and v2, and the unnormalized plane dot(normal, p) = distance.
+    struct precomputedTriangle
+    {
+        float edges[3][6];
+        float normal[3];
+        float distance;
+
+        explicit precomputedTriangle() = default;
+        explicit precomputedTriangle(const vec3f& v0, const vec3f& v1, const vec3f& v2)
+        {
+            pluckerEdge(v1, v2, edges[0]);
+            pluckerEdge(v2, v0, edges[1]);
+            pluckerEdge(v0, v1, edges[2]);
+
+            const vec3f n = cross(v1 - v0, v2 - v0);
+            normal[0] = n.getX();
+            normal[1] = n.getY();
+            normal[2] = n.getZ();
+            distance = dot(n, v0);
+        }
+    };
+
+    // Four or eight rays in lanes. Fill origin, direction and the t range, then call
+    // prepare() for the Plucker moment.
+    template<typename V>
+    struct tpacketRay
+    {
+        V origin[3];
+        V direction[3];
+        V moment[3];
+        V tMin;
+        V tMax;
+
+        inline void prepare()
+        {
+            moment[0] = origin[1] * direction[2] - origin[2] * direction[1];
+            moment[1] = origin[2] * direction[0] - origin[0] * direction[2];
+            moment[2] = origin[0] * direction[1] - origin[1] * direction[0];
+        }
+    };
+
+    template<typename V>
+    struct tpacketHit
+    {
+        V t;
+        V u;
+        V v;
+        V primitive; // Index bits, see V::fromBits.
+
+        inline void reset(const V& tMax)
+        {
+            t = tMax;
+            u = V::zero();
+            v = V::zero();
+            primitive = V::fromBits(kMissPrimitive);
+        }
+    };
+
+    namespace detail
+    {
+        // Triangle test in lanes, either one ray against several triangles or several rays
+        // against one broadcast triangle. Returns the hit mask within (tMin, t), where t
+        // is the closest hit so far, and the candidate t, u, v.
+        template<typename V>
+        inline V triangleLanes(
+            const V (&o)[3], const V (&d)[3], const V (&m)[3],
+            const V (&e)[3][6], const V (&n)[3], const V& distance,
+            const V& tMin, const V& tClosest,
+            V& t, V& u, V& v)
+        {
+            V side[3];
+            for (int32_t k = 0; k < 3; k++)
+            {
+                side[k] = dot3(d[0], d[1], d[2], e[k][3], e[k][4], e[k][5]) + dot3(e[k][0], e[k][1], e[k][2], m[0], m[1], m[2]);
+            }
+
+            const V zero = V::zero();
+            const V inside =
+                (min(min(side[0], side[1]), side[2]) >= zero) |
+                (max(max(side[0], side[1]), side[2]) <= zero);
+
+            const V sum = side[0] + side[1] + side[2];
+            t = (distance - dot3(n[0], n[1], n[2], o[0], o[1], o[2])) / dot3(n[0], n[1], n[2], d[0], d[1], d[2]);
+
+            const V inverse = V(1.0f) / sum;
+            u = side[1] * inverse;
+            v = side[2] * inverse;
+
+            // Ordered compares, NaN t from parallel rays or padding lanes never hits.
+            return inside & (abs(sum) > zero) & (t >= tMin) & (t < tClosest);
+        }
+
+        template<typename V>
+        inline V sphereLanes(const V (&o)[3], const V (&d)[3], const V (&c)[3], const V& radius, const V& tMin, const V& tClosest, V& t)
+        {
+            // Hearn-Baker form of the discriminant, robust for small far away spheres.
+            const V f[3] = { o[0] - c[0], o[1] - c[1], o[2] - c[2] };
+            const V a = dot3(d[0], d[1], d[2], d[0], d[1], d[2]);
+            const V b = -dot3(f[0], f[1], f[2], d[0], d[1], d[2]);
+
+            const V ba = b / a;
+            const V l[3] = { madd(d[0], ba, f[0]), madd(d[1], ba, f[1]), madd(d[2], ba, f[2]) };
+            const V r2 = radius * radius;
+            const V discriminant = r2 - dot3(l[0], l[1], l[2], l[0], l[1], l[2]);
+
+            const V root = sqrt(max(a * discriminant, V::zero()));
+            const V q = select(b < V::zero(), b - root, b + root);
+            const V cc = dot3(f[0], f[1], f[2], f[0], f[1], f[2]) - r2;
+
+            const V t0 = cc / q;
+            const V t1 = q / a;
+            const V nearT = min(t0, t1);
+            const V farT = max(t0, t1);
+
+            t = select(nearT >= tMin, nearT, farT);
+            return (discriminant >= V::zero()) & (t >= tMin) & (t < tClosest);
+        }
+
+        template<typename V>
+        inline V planeLanes(const V (&o)[3], const V (&d)[3], const V (&n)[3], const V& distance, const V& tMin, const V& tClosest, V& t)
+        {
+            t = (distance - dot3(n[0], n[1], n[2], o[0], o[1], o[2])) / dot3(n[0], n[1], n[2], d[0], d[1], d[2]);
+            return (t >= tMin) & (t < tClosest);
+        }
+
+        template<typename V>
+        inline void broadcast(const vec3f& v, V (&out)[3])
+        {
+            out[0] = V(v.getX());
+            out[1] = V(v.getY());
+            out[2] = V(v.getZ());
+        }
+
+        template<typename V>
+        inline void keepClosest(const V& mask, const V& t, const V& u, const V& v, const V& primitive, tpacketHit<V>& hit)
+        {
+            hit.t = select(mask, t, hit.t);
+            hit.u = select(mask, u, hit.u);
+            hit.v = select(mask, v, hit.v);
+            hit.primitive = select(mask, primitive, hit.primitive);
+        }
+
+        template<typename V>
+        inline V loadLanes(std::span<const float> in, size_t index, size_t lanes)
+        {
+            if (lanes == size_t(V::kWidth))
+            {
+                return V::load(&in[index]);
+            }
+
+            alignas(32) float tmp[V::kWidth] = { };
+            for (size_t l = 0; l < lanes; l++)
+            {
+                tmp[l] = in[index + l];
+            }
+            return V::loadAligned(tmp);
+        }
+    }
+
+    // Single ray against one triangle, sphere or plane. On a hit closer than hit.t, t, u
+    // and v are updated (spheres and planes have u = v = 0, like the packet forms;
+    // primitive is left to the caller) and true returned.
+
+    inline bool intersect(const ray& r, const precomputedTriangle& triangle, rayHit& hit)
+    {
+        const vec3f& o = r.getOrigin();
+        const vec3f& d = r.getDirection();
+        const vec3f m = cross(o, d);
+
+        float side[3];
+        for (int32_t k = 0; k < 3; k++)
+        {
+            const float (&e)[6] = triangle.edges[k];
+            side[k] = (d.getX() * e[3] + (d.getY() * e[4] + d.getZ() * e[5])) + (e[0] * m.getX() + (e[1] * m.getY() + e[2] * m.getZ()));
+        }
+
+        const bool inside =
+            (side[0] >= 0.0f && side[1] >= 0.0f && side[2] >= 0.0f) ||
+            (side[0] <= 0.0f && side[1] <= 0.0f && side[2] <= 0.0f);
+
+        const float sum = side[0] + side[1] + side[2];
+        if (!inside || sum == 0.0f)
+        {
+            return false;
+        }
+
+        const vec3f n(triangle.normal[0], triangle.normal[1], triangle.normal[2]);
+        const float t = (triangle.distance - dot(n, o)) / dot(n, d);
+        if (!(t >= r.getTMin() && t < std::min(r.getTMax(), hit.t)))
+        {
+            return false;
+        }
+
+        hit.t = t;
+        hit.u = side[1] / sum;
+        hit.v = side[2] / sum;
+        return true;
+    }
+
+    inline bool intersect(const ray& r, const vec3f& v0, const vec3f& v1, const vec3f& v2, rayHit& hit)
+    {
+        return intersect(r, precomputedTriangle(v0, v1, v2), hit);
+    }
+
+    inline bool intersectSphere(const ray& r, const vec3f& center, float radius, rayHit& hit)
+    {
+        const vec3f f = r.getOrigin() - center;
+        const vec3f& d = r.getDirection();
+
+        const float a = dot(d, d);
+        const float b = -dot(f, d);
+        const vec3f l = f + d * (b / a);
+        const float discriminant = radius * radius - dot(l, l);
+        if (discriminant < 0.0f)
+        {
+            return false;
+        }
+
+        const float root = std::sqrt(a * discriminant);
+        const float q = b < 0.0f ? b - root : b + root;
+        const float t0 = (dot(f, f) - radius * radius) / q;
+        const float t1 = q / a;
+
+        const float nearT = std::min(t0, t1);
+        const float t = nearT >= r.getTMin() ? nearT : std::max(t0, t1);
+        if (!(t >= r.getTMin() && t < std::min(r.getTMax(), hit.t)))
+        {
+            return false;
+        }
+
+        hit.t = t;
+        hit.u = 0.0f;
+        hit.v = 0.0f;
+        return true;
+    }
+
+    // Plane dot(normal, p) = distance.
+    inline bool intersectPlane(const ray& r, const vec3f& normal, float distance, rayHit& hit)
+    {
+        const float t = (distance - dot(normal, r.getOrigin())) / dot(normal, r.getDirection());
+        if (!(t >= r.getTMin() && t < std::min(r.getTMax(), hit.t)))
+        {
+            return false;
+        }
+
+        hit.t = t;
+        hit.u = 0.0f;
+        hit.v = 0.0f;
+        return true;
+    }
+
+    // Triangles of an indexed mesh, precomputed into blocks of eight with every field
+    // stored as eight consecutive floats so one block feeds a vfloat8 or two vfloat4
+    // loads per field. Unused lanes of the last block never hit.
+    class triangleSet
+    {
+    public:
+        static constexpr size_t kBlockWidth = 8;
+
+        struct block
+        {
+            alignas(32) float edges[3][6][kBlockWidth];
+            alignas(32) float normal[3][kBlockWidth];
+            alignas(32) float distance[kBlockWidth];
+        };
+
+        explicit triangleSet() = default;
+        explicit triangleSet(std::span<const vec3f> positions, std::span<const uint32_t> indices) { build(positions, indices); }
+
+        inline void build(std::span<const vec3f> positions, std::span<const uint32_t> indices)
+        {
+            assert(indices.size() % 3 == 0);
+
+            m_count = indices.size() / 3;
+            m_blocks.assign((m_count + kBlockWidth - 1) / kBlockWidth, block { });
+
+            for (size_t i = 0; i < m_count; i++)
+            {
+                const precomputedTriangle triangle(positions[indices[i * 3]], positions[indices[i * 3 + 1]], positions[indices[i * 3 + 2]]);
+
+                block& b = m_blocks[i / kBlockWidth];
+                const size_t lane = i % kBlockWidth;
+
+                for (int32_t k = 0; k < 3; k++)
+                {
+                    for (int32_t c = 0; c < 6; c++)
+                    {
+                        b.edges[k][c][lane] = triangle.edges[k][c];
+                    }
+                    b.normal[k][lane] = triangle.normal[k];
+                }
+                b.distance[lane] = triangle.distance;
+            }
+        }
+
+        inline size_t size() const { return m_count; }
+        inline std::span<const block> blocks() const { return m_blocks; }
+
+        inline precomputedTriangle get(size_t index) const
+        {
+            const block& b = m_blocks[index / kBlockWidth];
+            const size_t lane = index % kBlockWidth;
+
+            precomputedTriangle triangle;
+            for (int32_t k = 0; k < 3; k++)
+            {
+                for (int32_t c = 0; c < 6; c++)
+                {
+                    triangle.edges[k][c] = b.edges[k][c][lane];
+                }
+                triangle.normal[k] = b.normal[k][lane];
+            }
+            triangle.distance = b.distance[lane];
+            return triangle;
+        }
+
+    private:
+        std::vector<block> m_blocks;
+        size_t m_count = 0;
+    };
+
+    // One ray against every triangle, triangles in lanes.
+    template<typename V = vfloatn>
+    inline bool intersect(const ray& r, const triangleSet& triangles, rayHit& hit)
+    {
+        constexpr size_t width = size_t(V::kWidth);
+        static_assert(triangleSet::kBlockWidth % width == 0);
+
+        V o[3], d[3], m[3];
+        detail::broadcast(r.getOrigin(), o);
+        detail::broadcast(r.getDirection(), d);
+        detail::broadcast(cross(r.getOrigin(), r.getDirection()), m);
+
+        const V tMin(r.getTMin());
+        float closest = std::min(r.getTMax(), hit.t);
+        bool found = false;
+
+        const std::span<const triangleSet::block> blocks = triangles.blocks();
+        for (size_t b = 0; b < blocks.size(); b++)
+        {
+            for (size_t offset = 0; offset < triangleSet::kBlockWidth; offset += width)
+            {
+                const triangleSet::block& tri = blocks[b];
+
+                V e[3][6], n[3];
+                for (int32_t k = 0; k < 3; k++)
+                {
+                    for (int32_t c = 0; c < 6; c++)
+                    {
+                        e[k][c] = V::loadAligned(&tri.edges[k][c][offset]);
+                    }
+                    n[k] = V::loadAligned(&tri.normal[k][offset]);
+                }
+
+                V t, u, v;
+                const V mask = detail::triangleLanes(o, d, m, e, n, V::loadAligned(&tri.distance[offset]), tMin, V(closest), t, u, v);
+
+                int32_t bits = movemask(mask);
+                while (bits != 0)
+                {
+                    const int32_t lane = std::countr_zero(uint32_t(bits));
+                    bits &= bits - 1;
+
+                    if (t[lane] < closest)
+                    {
+                        closest = t[lane];
+                        hit.t = t[lane];
+                        hit.u = u[lane];
+                        hit.v = v[lane];
+                        hit.primitive = uint32_t(b * triangleSet::kBlockWidth + offset + lane);
+                        found = true;
+                    }
+                }
+            }
+        }
+        return found;
+    }
+
+    // A packet of rays against every triangle, rays in lanes.
+    template<typename V>
+    inline void intersect(const tpacketRay<V>& rays, const triangleSet& triangles, tpacketHit<V>& hit)
+    {
+        const std::span<const triangleSet::block> blocks = triangles.blocks();
+        for (size_t i = 0; i < triangles.size(); i++)
+        {
+            const triangleSet::block& tri = blocks[i / triangleSet::kBlockWidth];
+            const size_t lane = i % triangleSet::kBlockWidth;
+
+            V e[3][6], n[3];
+            for (int32_t k = 0; k < 3; k++)
+            {
+                for (int32_t c = 0; c < 6; c++)
+                {
+                    e[k][c] = V(tri.edges[k][c][lane]);
+                }
+                n[k] = V(tri.normal[k][lane]);
+            }
+
+            V t, u, v;
+            const V mask = detail::triangleLanes(rays.origin, rays.direction, rays.moment, e, n, V(tri.distance[lane]), rays.tMin, hit.t, t, u, v);
+            detail::keepClosest(mask, t, u, v, V::fromBits(uint32_t(i)), hit);
+        }
+    }
+
+    template<typename V>
+    inline void intersectSphere(const tpacketRay<V>& rays, const vec3f& center, float radius, uint32_t primitive, tpacketHit<V>& hit)
+    {
+        V c[3];
+        detail::broadcast(center, c);
+
+        V t;
+        const V mask = detail::sphereLanes(rays.origin, rays.direction, c, V(radius), rays.tMin, hit.t, t);
+        detail::keepClosest(mask, t, V::zero(), V::zero(), V::fromBits(primitive), hit);
+    }
+
+    template<typename V>
+    inline void intersectPlane(const tpacketRay<V>& rays, const vec3f& normal, float distance, uint32_t primitive, tpacketHit<V>& hit)
+    {
+        V n[3];
+        detail::broadcast(normal, n);
+
+        V t;
+        const V mask = detail::planeLanes(rays.origin, rays.direction, n, V(distance), rays.tMin, hit.t, t);
+        detail::keepClosest(mask, t, V::zero(), V::zero(), V::fromBits(primitive), hit);
+    }
+
+    // Long ray streams in SoA form, cut into packets of V::kWidth rays.
+    struct rayStream
+    {
+        csoa3f origin;
+        csoa3f direction;
+        std::span<const float> tMin;
+        std::span<const float> tMax;
+
+        inline size_t size() const { return origin.size(); }
+    };
+
+    namespace detail
+    {
+        template<typename V>
+        inline void loadPacket(const rayStream& rays, size_t index, size_t lanes, tpacketRay<V>& packet)
+        {
+            packet.origin[0] = loadLanes<V>(rays.origin.x(), index, lanes);
+            packet.origin[1] = loadLanes<V>(rays.origin.y(), index, lanes);
+            packet.origin[2] = loadLanes<V>(rays.origin.z(), index, lanes);
+            packet.direction[0] = loadLanes<V>(rays.direction.x(), index, lanes);
+            packet.direction[1] = loadLanes<V>(rays.direction.y(), index, lanes);
+            packet.direction[2] = loadLanes<V>(rays.direction.z(), index, lanes);
+            packet.tMin = loadLanes<V>(rays.tMin, index, lanes);
+            packet.tMax = loadLanes<V>(rays.tMax, index, lanes);
+            packet.prepare();
+        }
+
+        template<typename V>
+        inline void storeHits(const tpacketHit<V>& hit, std::span<rayHit> hits, size_t index, size_t lanes)
+        {
+            alignas(32) float t[V::kWidth], u[V::kWidth], v[V::kWidth];
+            alignas(32) uint32_t primitive[V::kWidth];
+            hit.t.storeAligned(t);
+            hit.u.storeAligned(u);
+            hit.v.storeAligned(v);
+            hit.primitive.storeBits(primitive);
+
+            for (size_t l = 0; l < lanes; l++)
+            {
+                hits[index + l] = rayHit { t[l], u[l], v[l], primitive[l] };
+            }
+        }
+
+        template<typename V, typename Kernel>
+        inline void streamPackets(const rayStream& rays, std::span<rayHit> hits, uint32_t threadCount, Kernel&& kernel)
+        {
+            assert(rays.direction.size() >= rays.size() && rays.tMin.size() >= rays.size() && rays.tMax.size() >= rays.size());
+            assert(hits.size() >= rays.size());
+
+            constexpr size_t width = size_t(V::kWidth);
+            parallelFor(rays.size(), 1024, threadCount, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i += width)
+                {
+                    const size_t lanes = std::min(width, end - i);
+
+                    tpacketRay<V> packet;
+                    loadPacket(rays, i, lanes, packet);
+
+                    tpacketHit<V> hit;
+                    hit.reset(packet.tMax);
+                    kernel(packet, hit);
+
+                    storeHits(hit, hits, i, lanes);
+                }
+            });
+        }
+    }
+
+    // Closest triangle of every ray.
+    template<typename V = vfloatn>
+    inline void intersect(const rayStream& rays, const triangleSet& triangles, std::span<rayHit> hits, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("intersect::triangleStream", V::kPath, rays.size() * triangles.size(),
+            rays.size() * (sizeof(float) * 8 + sizeof(rayHit)));
+
+        detail::streamPackets<V>(rays, hits, threadCount, [&](const tpacketRay<V>& packet, tpacketHit<V>& hit)
+        {
+            intersect(packet, triangles, hit);
+        });
+    }
+
+    template<typename V = vfloatn>
+    inline void intersectSphere(const rayStream& rays, const vec3f& center, float radius, std::span<rayHit> hits, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("intersect::sphereStream", V::kPath, rays.size(), rays.size() * (sizeof(float) * 8 + sizeof(rayHit)));
+
+        detail::streamPackets<V>(rays, hits, threadCount, [&](const tpacketRay<V>& packet, tpacketHit<V>& hit)
+        {
+            intersectSphere(packet, center, radius, 0, hit);
+        });
+    }
+
+    template<typename V = vfloatn>
+    inline void intersectPlane(const rayStream& rays, const vec3f& normal, float distance, std::span<rayHit> hits, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("intersect::planeStream", V::kPath, rays.size(), rays.size() * (sizeof(float) * 8 + sizeof(rayHit)));
+
+        detail::streamPackets<V>(rays, hits, threadCount, [&](const tpacketRay<V>& packet, tpacketHit<V>& hit)
+        {
+            intersectPlane(packet, normal, distance, 0, hit);
+        });
+    }
+
+    // Final export class.
+    using packetRay4 = tpacketRay<vfloat4>;
+    using packetHit4 = tpacketHit<vfloat4>;
+#if EULER_HAS_VFLOAT8
+    using packetRay8 = tpacketRay<vfloat8>;
+    using packetHit8 = tpacketHit<vfloat8>;
+#endif
+}
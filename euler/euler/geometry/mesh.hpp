@@ -0,0 +1,829 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "../scalar/tvec2.hpp"
+#include "../scalar/tvec3.hpp"
+#include "../scalar/tvec4.hpp"
+#include "../simd/vfloat4.hpp"
+#include "../simd/vfloat8.hpp"
+#include "../core/parallel.hpp"
+#include "../core/instrument.hpp"
+
+namespace euler
+{
+    // Vertex normals and tangents of indexed triangle meshes. Triangles are taken in
+    // fixed chunks; the triangles of a chunk are computed in lanes and their corner terms
+    // added into four floats per vertex over the vertex range the chunk touches. Then
+    // every vertex adds up the chunks covering it, in chunk order, and is finished in
+    // lanes. Chunks do not depend on the thread count and neither does the result.
+
+    enum class normalWeight
+    {
+        area,  // Face normal scaled by twice the triangle area.
+        angle, // Unit face normal scaled by the corner angle, independent of triangulation.
+    };
+
+    enum class tangentWeight
+    {
+        face,  // Unit face tangent, every face counting once, as the classic per triangle loop.
+        angle, // MikkTSpace: projected into the plane of the corner's normal, scaled by the corner angle there.
+    };
+
+    namespace detail
+    {
+        constexpr size_t kMeshChunk = 1 << 14; // Triangles.
+        constexpr size_t kMeshGrain = 1024;    // Vertices finished together.
+
+        // Corner sums of one chunk, vertices first .. first + count - 1 from `values`. A
+        // chunk whose indices spread over more vertices than it has corners adds into the
+        // buffer shared by all such chunks instead, keeping scratch memory bounded.
+        struct cornerSums
+        {
+            uint32_t first = 0;
+            uint32_t count = 0;
+            bool shared = false;
+            vfloat4* values = nullptr;
+        };
+
+        template<typename V>
+        inline void cross3(const V (&a)[3], const V (&b)[3], V (&out)[3])
+        {
+            out[0] = a[1] * b[2] - a[2] * b[1];
+            out[1] = a[2] * b[0] - a[0] * b[2];
+            out[2] = a[0] * b[1] - a[1] * b[0];
+        }
+
+        // Zero vectors stay zero.
+        template<typename V>
+        inline void normalize3(V (&v)[3])
+        {
+            const V lengthSquare = dot3(v, v);
+            const V inverse = select(lengthSquare > V::zero(), V(1.0f) / sqrt(lengthSquare), V::zero());
+            v[0] *= inverse;
+            v[1] *= inverse;
+            v[2] *= inverse;
+        }
+
+        // Removes the part of v along the unit vector n.
+        template<typename V>
+        inline void project3(const V (&n)[3], V (&v)[3])
+        {
+            const V d = dot3(n, v);
+            v[0] -= n[0] * d;
+            v[1] -= n[1] * d;
+            v[2] -= n[2] * d;
+        }
+
+        // acos within 7e-5 rad (Abramowitz and Stegun 4.4.45), plenty for weights.
+        template<typename V>
+        inline V acosApprox(const V& x)
+        {
+            const V a = min(abs(x), V(1.0f));
+            const V poly = madd(madd(madd(V(-0.0187293f), a, V(0.0742610f)), a, V(-0.2121144f)), a, V(1.5707288f));
+            const V r = sqrt(V(1.0f) - a) * poly;
+            return select(x < V::zero(), V(3.14159265f) - r, r);
+        }
+
+        // Angle between a and b, zero when either is degenerate.
+        template<typename V>
+        inline V angleBetween(const V (&a)[3], const V (&b)[3])
+        {
+            const V denominator = dot3(a, a) * dot3(b, b);
+            return select(denominator > V::zero(), acosApprox(dot3(a, b) / sqrt(denominator)), V::zero());
+        }
+
+        template<typename V>
+        inline void edge3(const V (&from)[3], const V (&to)[3], V (&out)[3])
+        {
+            out[0] = to[0] - from[0];
+            out[1] = to[1] - from[1];
+            out[2] = to[2] - from[2];
+        }
+
+        // x, y, z of values[index] in the first three floats, reading the next element's x
+        // when there is one rather than assembling the row from scalars.
+        inline __m128 loadRow(std::span<const vec3f> values, uint32_t index)
+        {
+            if (size_t(index) + 1 < values.size())
+            {
+                return _mm_loadu_ps(reinterpret_cast<const float*>(&values[index]));
+            }
+
+            const vec3f& v = values[index];
+            return _mm_setr_ps(v.getX(), v.getY(), v.getZ(), 0.0f);
+        }
+
+        inline __m128 loadRow(std::span<const vec2f> values, uint32_t index)
+        {
+            return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(&values[index])));
+        }
+
+        // Rows of four or eight lanes of four columns.
+        inline void transposeColumns(const vfloat4 (&columns)[4], __m128 (&rows)[4])
+        {
+            for (int32_t c = 0; c < 4; c++)
+            {
+                rows[c] = columns[c].get();
+            }
+            _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        }
+
+        // store(l, row) for the rows l = 0 .. kWidth - 1 of four columns, the lanes spelled out
+        // like gatherRows.
+        template<typename Store>
+        inline void scatterRows(const vfloat4 (&columns)[4], const Store& store)
+        {
+            __m128 rows[4];
+            transposeColumns(columns, rows);
+            store(0, rows[0]);
+            store(1, rows[1]);
+            store(2, rows[2]);
+            store(3, rows[3]);
+        }
+
+        // Columns x, y, z and, when asked for, w of the rows load(0) .. load(kWidth - 1), the
+        // lanes spelled out so that the rows stay in registers.
+        template<typename Load, int32_t columns>
+        inline void gatherRows(const Load& load, vfloat4 (&out)[columns])
+        {
+            __m128 rows[4] = { load(0), load(1), load(2), load(3) };
+            _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+            for (int32_t c = 0; c < columns; c++)
+            {
+                out[c] = vfloat4(rows[c]);
+            }
+        }
+
+#if EULER_HAS_VFLOAT8
+        // Rows l and l + 4 share a register and are transposed within the halves.
+        template<typename Load, int32_t columns>
+        inline void gatherRows(const Load& load, vfloat8 (&out)[columns])
+        {
+            const __m256 pairs[4] =
+            {
+                _mm256_insertf128_ps(_mm256_castps128_ps256(load(0)), load(4), 1),
+                _mm256_insertf128_ps(_mm256_castps128_ps256(load(1)), load(5), 1),
+                _mm256_insertf128_ps(_mm256_castps128_ps256(load(2)), load(6), 1),
+                _mm256_insertf128_ps(_mm256_castps128_ps256(load(3)), load(7), 1),
+            };
+
+            const __m256 xy01 = _mm256_unpacklo_ps(pairs[0], pairs[1]);
+            const __m256 zw01 = _mm256_unpackhi_ps(pairs[0], pairs[1]);
+            const __m256 xy23 = _mm256_unpacklo_ps(pairs[2], pairs[3]);
+            const __m256 zw23 = _mm256_unpackhi_ps(pairs[2], pairs[3]);
+            out[0] = vfloat8(_mm256_shuffle_ps(xy01, xy23, _MM_SHUFFLE(1, 0, 1, 0)));
+            out[1] = vfloat8(_mm256_shuffle_ps(xy01, xy23, _MM_SHUFFLE(3, 2, 3, 2)));
+            out[2] = vfloat8(_mm256_shuffle_ps(zw01, zw23, _MM_SHUFFLE(1, 0, 1, 0)));
+            if constexpr (columns == 4)
+            {
+                out[3] = vfloat8(_mm256_shuffle_ps(zw01, zw23, _MM_SHUFFLE(3, 2, 3, 2)));
+            }
+        }
+
+        template<typename Store>
+        inline void scatterRows(const vfloat8 (&columns)[4], const Store& store)
+        {
+            const __m256 xy01 = _mm256_unpacklo_ps(columns[0].get(), columns[1].get());
+            const __m256 xy23 = _mm256_unpackhi_ps(columns[0].get(), columns[1].get());
+            const __m256 zw01 = _mm256_unpacklo_ps(columns[2].get(), columns[3].get());
+            const __m256 zw23 = _mm256_unpackhi_ps(columns[2].get(), columns[3].get());
+            const __m256 pairs[4] =
+            {
+                _mm256_shuffle_ps(xy01, zw01, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(xy01, zw01, _MM_SHUFFLE(3, 2, 3, 2)),
+                _mm256_shuffle_ps(xy23, zw23, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(xy23, zw23, _MM_SHUFFLE(3, 2, 3, 2)),
+            };
+            store(0, _mm256_castps256_ps128(pairs[0]));
+            store(1, _mm256_castps256_ps128(pairs[1]));
+            store(2, _mm256_castps256_ps128(pairs[2]));
+            store(3, _mm256_castps256_ps128(pairs[3]));
+            store(4, _mm256_extractf128_ps(pairs[0], 1));
+            store(5, _mm256_extractf128_ps(pairs[1], 1));
+            store(6, _mm256_extractf128_ps(pairs[2], 1));
+            store(7, _mm256_extractf128_ps(pairs[3], 1));
+        }
+
+        inline void transposeColumns(const vfloat8 (&columns)[4], __m128 (&rows)[8])
+        {
+            const __m256 xy01 = _mm256_unpacklo_ps(columns[0].get(), columns[1].get());
+            const __m256 xy23 = _mm256_unpackhi_ps(columns[0].get(), columns[1].get());
+            const __m256 zw01 = _mm256_unpacklo_ps(columns[2].get(), columns[3].get());
+            const __m256 zw23 = _mm256_unpackhi_ps(columns[2].get(), columns[3].get());
+            const __m256 pairs[4] =
+            {
+                _mm256_shuffle_ps(xy01, zw01, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(xy01, zw01, _MM_SHUFFLE(3, 2, 3, 2)),
+                _mm256_shuffle_ps(xy23, zw23, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(xy23, zw23, _MM_SHUFFLE(3, 2, 3, 2)),
+            };
+            for (int32_t l = 0; l < 4; l++)
+            {
+                rows[l] = _mm256_castps256_ps128(pairs[l]);
+                rows[l + 4] = _mm256_extractf128_ps(pairs[l], 1);
+            }
+        }
+#endif
+
+        // Attribute of the three corners of triangles first .. first + lanes - 1, zero in unused lanes.
+        template<typename V, typename Vec, int32_t components>
+        inline void gatherCorners(std::span<const Vec> attribute, std::span<const uint32_t> indices, size_t first, size_t lanes,
+            V (&out)[3][components])
+        {
+            for (int32_t k = 0; k < 3; k++)
+            {
+                V columns[3];
+                gatherRows([&](size_t l) { return l < lanes ? loadRow(attribute, indices[(first + l) * 3 + k]) : _mm_setzero_ps(); }, columns);
+                for (int32_t c = 0; c < components; c++)
+                {
+                    out[k][c] = columns[c];
+                }
+            }
+        }
+
+        // Index order: unsigned with SSE4.1, otherwise signed, on indices whose sign bits
+        // indexBounds has flipped.
+        inline __m128i minIndex(__m128i a, __m128i b)
+        {
+#if defined(__SSE4_1__) || defined(__AVX__)
+            return _mm_min_epu32(a, b);
+#else
+            const __m128i greater = _mm_cmpgt_epi32(a, b);
+            return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+#endif
+        }
+
+        inline __m128i maxIndex(__m128i a, __m128i b)
+        {
+#if defined(__SSE4_1__) || defined(__AVX__)
+            return _mm_max_epu32(a, b);
+#else
+            const __m128i greater = _mm_cmpgt_epi32(a, b);
+            return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+#endif
+        }
+
+        // Smallest and largest of a non empty run of indices.
+        inline void indexBounds(const uint32_t* indices, size_t count, uint32_t& low, uint32_t& high)
+        {
+#if defined(__SSE4_1__) || defined(__AVX__)
+            const __m128i bias = _mm_setzero_si128();
+#else
+            const __m128i bias = _mm_set1_epi32(INT32_MIN);
+#endif
+            // Two accumulators each, halving the dependency chains of the compares.
+            __m128i lows = _mm_xor_si128(_mm_set1_epi32(-1), bias), highs = bias, lows1 = lows, highs1 = highs;
+
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i v0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i)), bias);
+                const __m128i v1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i + 4)), bias);
+                lows = minIndex(lows, v0);
+                highs = maxIndex(highs, v0);
+                lows1 = minIndex(lows1, v1);
+                highs1 = maxIndex(highs1, v1);
+            }
+            if (i + 4 <= count)
+            {
+                const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i)), bias);
+                lows1 = minIndex(lows1, v);
+                highs1 = maxIndex(highs1, v);
+                i += 4;
+            }
+            lows = minIndex(lows, lows1);
+            highs = maxIndex(highs, highs1);
+
+            alignas(16) uint32_t l[4], h[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(l), _mm_xor_si128(lows, bias));
+            _mm_store_si128(reinterpret_cast<__m128i*>(h), _mm_xor_si128(highs, bias));
+
+            low = std::min(std::min(l[0], l[1]), std::min(l[2], l[3]));
+            high = std::max(std::max(h[0], h[1]), std::max(h[2], h[3]));
+            for (; i < count; i++)
+            {
+                low = std::min(low, indices[i]);
+                high = std::max(high, indices[i]);
+            }
+        }
+
+        // The sum plus zero, which makes a -0 sum the +0 of the zero filled sums of the
+        // threaded path.
+        inline __m128 loadSum(const vfloat4& sum)
+        {
+            return _mm_add_ps(_mm_setzero_ps(), sum.get());
+        }
+
+        // Sums the corner terms of every vertex, addTerms(begin, end, sums, first) adding those
+        // of triangles [begin, end) into sums[index - first], then calls finish(v, count, sums)
+        // for blocks of at most kMeshGrain vertices with sums[i] holding vertex v + i.
+        // Per vertex, the chunks are added in chunk order and the shared buffer last, on
+        // both paths, so the sums do not depend on the thread count.
+        template<typename AddTerms, typename Finish>
+        inline void sumCorners(std::span<const uint32_t> indices, size_t vertexCount, uint32_t threadCount,
+            AddTerms&& addTerms, Finish&& finish)
+        {
+            assert(indices.size() % 3 == 0 && vertexCount <= size_t(UINT32_MAX));
+
+            const size_t triangleCount = indices.size() / 3;
+            const size_t chunkCount = (triangleCount + kMeshChunk - 1) / kMeshChunk;
+            std::vector<cornerSums> chunks(chunkCount);
+
+            auto measure = [&](size_t c)
+            {
+                const size_t begin = c * kMeshChunk, end = std::min(triangleCount, begin + kMeshChunk);
+
+                uint32_t low, high;
+                indexBounds(indices.data() + begin * 3, (end - begin) * 3, low, high);
+                assert(high < vertexCount);
+
+                chunks[c].first = low;
+                chunks[c].count = high - low + 1;
+                chunks[c].shared = size_t(high - low) >= (end - begin) * 3;
+            };
+
+            auto addChunk = [&](size_t c, vfloat4* sums, uint32_t first)
+            {
+                addTerms(c * kMeshChunk, std::min(triangleCount, (c + 1) * kMeshChunk), sums, first);
+            };
+
+            parallelFor(chunkCount, 1, threadCount, [&](size_t begin, size_t end)
+            {
+                for (size_t c = begin; c < end; c++)
+                {
+                    measure(c);
+                }
+            });
+
+            // One thread streams the chunks when none is shared and their first vertices never
+            // go back, as in meshes cooked in vertex order: each vertex below the next chunk's
+            // first is complete and finished while still in cache. Anything else takes the
+            // general path below, on however many threads.
+            bool streamed = resolveThreadCount(threadCount) == 1 || chunkCount <= 1;
+            for (size_t c = 0; c < chunkCount && streamed; c++)
+            {
+                streamed = !chunks[c].shared && (c == 0 || chunks[c].first >= chunks[c - 1].first);
+            }
+
+            if (streamed)
+            {
+                // window[i] sums vertex open + i, every vertex below open is finished. What a
+                // chunk leaves for later chunks is carried over, usually a few rows of vertices.
+                std::vector<vfloat4> window, carry;
+                size_t open = 0;
+
+                auto finishBelow = [&](size_t end)
+                {
+                    const size_t count = end - open;
+                    window.resize(std::max(window.size(), count), vfloat4::zero());
+                    for (size_t i = 0; i < count; i += kMeshGrain)
+                    {
+                        finish(open + i, std::min(kMeshGrain, count - i), window.data() + i);
+                    }
+                    carry.assign(window.begin() + count, window.end());
+                    open = end;
+                };
+
+                // Between chunks open is the next chunk's first vertex, so its sums line up with
+                // the window.
+                finishBelow(chunkCount > 0 ? chunks[0].first : vertexCount);
+                for (size_t c = 0; c < chunkCount; c++)
+                {
+                    window.assign(std::max<size_t>(chunks[c].count, carry.size()), vfloat4::zero());
+                    addChunk(c, window.data(), chunks[c].first);
+                    for (size_t i = 0; i < carry.size(); i++)
+                    {
+                        window[i] = carry[i] + window[i];
+                    }
+
+                    finishBelow(c + 1 < chunkCount ? chunks[c + 1].first : vertexCount);
+                }
+                return;
+            }
+
+            // One scratch allocation for every chunk, first touched by the thread summing it.
+            size_t scratchSize = 0;
+            for (const cornerSums& chunk : chunks)
+            {
+                scratchSize += chunk.shared ? 0 : chunk.count;
+            }
+            std::unique_ptr<vfloat4[]> scratch(new vfloat4[scratchSize]);
+            for (size_t c = 0, offset = 0; c < chunkCount; c++)
+            {
+                chunks[c].values = chunks[c].shared ? nullptr : scratch.get() + offset;
+                offset += chunks[c].shared ? 0 : chunks[c].count;
+            }
+
+            parallelFor(chunkCount, 1, threadCount, [&](size_t begin, size_t end)
+            {
+                for (size_t c = begin; c < end; c++)
+                {
+                    if (!chunks[c].shared)
+                    {
+                        std::fill(chunks[c].values, chunks[c].values + chunks[c].count, vfloat4::zero());
+                        addChunk(c, chunks[c].values, chunks[c].first);
+                    }
+                }
+            });
+
+            std::vector<vfloat4> shared;
+            for (size_t c = 0; c < chunkCount; c++)
+            {
+                if (chunks[c].shared)
+                {
+                    shared.resize(vertexCount, vfloat4::zero());
+                    addChunk(c, shared.data(), 0);
+                }
+            }
+
+            // Chunks overlapping each group of kMeshGrain vertices, in chunk order.
+            std::vector<std::vector<uint32_t>> grains((vertexCount + kMeshGrain - 1) / kMeshGrain);
+            for (size_t c = 0; c < chunkCount; c++)
+            {
+                if (!chunks[c].shared)
+                {
+                    const size_t last = (size_t(chunks[c].first) + chunks[c].count - 1) / kMeshGrain;
+                    for (size_t g = chunks[c].first / kMeshGrain; g <= last; g++)
+                    {
+                        grains[g].push_back(uint32_t(c));
+                    }
+                }
+            }
+
+            parallelFor(vertexCount, kMeshGrain, threadCount, [&](size_t begin, size_t end)
+            {
+                vfloat4 sums[kMeshGrain];
+
+                for (size_t grainBegin = begin; grainBegin < end; grainBegin += kMeshGrain)
+                {
+                    const size_t grainEnd = std::min(end, grainBegin + kMeshGrain);
+                    std::fill(sums, sums + (grainEnd - grainBegin), vfloat4::zero());
+
+                    for (uint32_t c : grains[grainBegin / kMeshGrain])
+                    {
+                        const cornerSums& chunk = chunks[c];
+                        const size_t from = std::max<size_t>(grainBegin, chunk.first);
+                        const size_t to = std::min<size_t>(grainEnd, size_t(chunk.first) + chunk.count);
+                        for (size_t v = from; v < to; v++)
+                        {
+                            sums[v - grainBegin] += chunk.values[v - chunk.first];
+                        }
+                    }
+
+                    for (size_t v = grainBegin; v < grainEnd && !shared.empty(); v++)
+                    {
+                        sums[v - grainBegin] += shared[v];
+                    }
+
+                    finish(grainBegin, grainEnd - grainBegin, sums);
+                }
+            });
+        }
+
+        // cross(a, b) of two xyz rows, w left undefined.
+        inline __m128 crossRows(__m128 a, __m128 b)
+        {
+            const __m128 zxy = _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1))),
+                _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), b));
+            return _mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(3, 0, 2, 1));
+        }
+
+        // Area weights need nothing but the face normal, taken triangle by triangle on rows;
+        // angle weights go through lanes and scale the unit normal row by each corner's
+        // angle. w of the terms is not used by the normals.
+        template<normalWeight weight, typename V>
+        inline void addNormalTerms(std::span<const vec3f> positions, std::span<const uint32_t> indices, size_t begin, size_t end,
+            vfloat4* sums, uint32_t first)
+        {
+            if constexpr (weight == normalWeight::area)
+            {
+                for (size_t t = begin; t < end; t++)
+                {
+                    const uint32_t* corners = &indices[t * 3];
+                    const __m128 p0 = loadRow(positions, corners[0]);
+                    const vfloat4 n(crossRows(_mm_sub_ps(loadRow(positions, corners[1]), p0), _mm_sub_ps(loadRow(positions, corners[2]), p0)));
+                    sums[corners[0] - first] += n;
+                    sums[corners[1] - first] += n;
+                    sums[corners[2] - first] += n;
+                }
+            }
+            else
+            {
+                for (size_t t = begin; t < end; t += size_t(V::kWidth))
+                {
+                    const size_t lanes = std::min(size_t(V::kWidth), end - t);
+
+                    V p[3][3];
+                    gatherCorners(positions, indices, t, lanes, p);
+
+                    V e1[3], e2[3], n[3];
+                    edge3(p[0], p[1], e1);
+                    edge3(p[0], p[2], e2);
+                    cross3(e1, e2, n);
+                    normalize3(n);
+
+                    // The corner angles add up to pi, leaving the third one for free.
+                    alignas(32) float angles[3][V::kWidth];
+                    V e12[3], minusE1[3] = { -e1[0], -e1[1], -e1[2] };
+                    edge3(p[1], p[2], e12);
+                    const V angle0 = angleBetween(e1, e2), angle1 = angleBetween(minusE1, e12);
+                    angle0.storeAligned(angles[0]);
+                    angle1.storeAligned(angles[1]);
+                    (V(3.14159265f) - angle0 - angle1).storeAligned(angles[2]);
+
+                    __m128 normalRows[V::kWidth];
+                    transposeColumns({ n[0], n[1], n[2], V::zero() }, normalRows);
+                    for (size_t l = 0; l < lanes; l++)
+                    {
+                        const uint32_t* corners = &indices[(t + l) * 3];
+                        for (int32_t k = 0; k < 3; k++)
+                        {
+                            sums[corners[k] - first] += vfloat4(_mm_mul_ps(normalRows[l], _mm_set1_ps(angles[k][l])));
+                        }
+                    }
+                }
+            }
+        }
+
+        // dP/du of a triangle up to a positive scale in xyz, its signed uv area in w.
+        inline __m128 faceTangentRow(std::span<const vec3f> positions, std::span<const vec2f> uvs, const uint32_t* corners)
+        {
+            const __m128 p0 = loadRow(positions, corners[0]), uv0 = loadRow(uvs, corners[0]);
+            const __m128 t21 = _mm_sub_ps(loadRow(uvs, corners[1]), uv0), t31 = _mm_sub_ps(loadRow(uvs, corners[2]), uv0);
+            const __m128 direction = _mm_sub_ps(
+                _mm_mul_ps(_mm_sub_ps(loadRow(positions, corners[1]), p0), _mm_shuffle_ps(t31, t31, _MM_SHUFFLE(1, 1, 1, 1))),
+                _mm_mul_ps(_mm_sub_ps(loadRow(positions, corners[2]), p0), _mm_shuffle_ps(t21, t21, _MM_SHUFFLE(1, 1, 1, 1))));
+
+            // t21.x * t31.y - t21.y * t31.x into w.
+            const __m128 products = _mm_mul_ps(t21, _mm_shuffle_ps(t31, t31, _MM_SHUFFLE(0, 0, 0, 1)));
+            const __m128 area = _mm_sub_ss(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(1, 1, 1, 1)));
+            return _mm_shuffle_ps(direction, _mm_shuffle_ps(direction, area, _MM_SHUFFLE(0, 0, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+        }
+
+        // The face term of a row from faceTangentRow: xyz scaled to unit length and signed by
+        // the uv orientation, which w holds, or zero for degenerate uvs.
+        inline __m128 faceTangentTerm(__m128 row)
+        {
+            alignas(16) float s[4];
+            _mm_store_ps(s, row);
+
+            const bool valid = std::abs(s[3]) > 0.0f;
+            const float orientation = s[3] > 0.0f ? 1.0f : -1.0f;
+            const float lengthSquare = s[0] * s[0] + s[1] * s[1] + s[2] * s[2];
+            const float scale = valid && lengthSquare > 0.0f ? orientation / std::sqrt(lengthSquare) : 0.0f;
+            return _mm_setr_ps(s[0] * scale, s[1] * scale, s[2] * scale, valid ? orientation : 0.0f);
+        }
+
+        // Per corner tangent terms from the face direction of increasing u: the same unit
+        // vector for every corner with face weights, or following MikkTSpace, projected into
+        // the tangent plane of the corner's vertex normal and scaled by the corner angle in
+        // that plane. w carries the weight signed by the face's uv orientation. Faces with
+        // degenerate uvs contribute nothing.
+        template<tangentWeight weight, typename V>
+        inline void addTangentTerms(std::span<const vec3f> positions, std::span<const vec3f> normals, std::span<const vec2f> uvs,
+            std::span<const uint32_t> indices, size_t begin, size_t end, vfloat4* sums, uint32_t first)
+        {
+            const V zero = V::zero(), one(1.0f);
+            if constexpr (weight == tangentWeight::face)
+            {
+                // Rows of dP/du and the signed uv area, made triangle by triangle and
+                // normalized in lanes.
+                for (size_t t = begin; t < end; t += size_t(V::kWidth))
+                {
+                    const size_t lanes = std::min(size_t(V::kWidth), end - t);
+
+                    __m128 rows[V::kWidth];
+                    for (size_t l = 0; l < size_t(V::kWidth); l++)
+                    {
+                        if (l >= lanes)
+                        {
+                            rows[l] = _mm_setzero_ps();
+                            continue;
+                        }
+
+                        rows[l] = faceTangentRow(positions, uvs, &indices[(t + l) * 3]);
+                    }
+
+                    V s[4];
+                    gatherRows([&](size_t l) { return rows[l]; }, s);
+
+                    const V valid = abs(s[3]) > zero;
+                    const V orientation = select(s[3] > zero, one, -one);
+                    const V lengthSquare = dot3(s[0], s[1], s[2], s[0], s[1], s[2]);
+                    const V scale = select(valid & (lengthSquare > zero), orientation / sqrt(lengthSquare), zero);
+
+                    transposeColumns({ s[0] * scale, s[1] * scale, s[2] * scale, select(valid, orientation, zero) }, rows);
+                    for (size_t l = 0; l < lanes; l++)
+                    {
+                        const uint32_t* corners = &indices[(t + l) * 3];
+                        const vfloat4 term(rows[l]);
+                        sums[corners[0] - first] += term;
+                        sums[corners[1] - first] += term;
+                        sums[corners[2] - first] += term;
+                    }
+                }
+                return;
+            }
+
+            for (size_t t = begin; t < end; t += size_t(V::kWidth))
+            {
+                const size_t lanes = std::min(size_t(V::kWidth), end - t);
+
+                V p[3][3], uv[3][2];
+                gatherCorners(positions, indices, t, lanes, p);
+                gatherCorners(uvs, indices, t, lanes, uv);
+
+                V d1[3], d2[3];
+                edge3(p[0], p[1], d1);
+                edge3(p[0], p[2], d2);
+
+                const V t21x = uv[1][0] - uv[0][0], t21y = uv[1][1] - uv[0][1];
+                const V t31x = uv[2][0] - uv[0][0], t31y = uv[2][1] - uv[0][1];
+                const V signedArea = t21x * t31y - t21y * t31x;
+
+                // dP/du up to a positive scale.
+                V s[3];
+                for (int32_t c = 0; c < 3; c++)
+                {
+                    s[c] = t31y * d1[c] - t21y * d2[c];
+                }
+
+                const V valid = abs(signedArea) > zero;
+                const V orientation = select(signedArea > zero, one, -one);
+                const V lengthSquare = dot3(s, s);
+                const V scale = select(valid & (lengthSquare > zero), orientation / sqrt(lengthSquare), zero);
+                for (int32_t c = 0; c < 3; c++)
+                {
+                    s[c] *= scale;
+                }
+
+                V n[3][3];
+                gatherCorners(normals, indices, t, lanes, n);
+
+                __m128 rows[3][V::kWidth];
+                for (int32_t k = 0; k < 3; k++)
+                {
+                    V tangent[3] = { s[0], s[1], s[2] };
+                    project3(n[k], tangent);
+
+                    V a[3], b[3];
+                    edge3(p[k], p[(k + 1) % 3], a);
+                    edge3(p[k], p[(k + 2) % 3], b);
+                    project3(n[k], a);
+                    project3(n[k], b);
+
+                    // One division for both the angle's cosine and the tangent's length.
+                    const V tangentSquare = dot3(tangent, tangent), edges = dot3(a, a) * dot3(b, b);
+                    const V usable = tangentSquare > zero, angular = edges > zero;
+                    const V length = select(usable, sqrt(tangentSquare), one), root = sqrt(edges);
+                    const V inverse = select(angular, one / (length * root), zero);
+                    const V angle = select(angular, acosApprox(dot3(a, b) * length * inverse), zero);
+                    const V scaled = select(usable, angle * root * inverse, zero);
+
+                    transposeColumns({ tangent[0] * scaled, tangent[1] * scaled, tangent[2] * scaled, select(valid, orientation * angle, zero) }, rows[k]);
+                }
+
+                for (size_t l = 0; l < lanes; l++)
+                {
+                    const uint32_t* corners = &indices[(t + l) * 3];
+                    for (int32_t k = 0; k < 3; k++)
+                    {
+                        sums[corners[k] - first] += vfloat4(rows[k][l]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Smooth normal of every vertex from the triangles using it. Vertices no triangle
+    // uses, or only degenerate ones, get a zero normal.
+    template<normalWeight weight = normalWeight::angle, typename V = vfloatn>
+    inline void computeVertexNormals(std::span<const vec3f> positions, std::span<const uint32_t> indices, std::span<vec3f> normals,
+        uint32_t threadCount = 1)
+    {
+        assert(normals.size() >= positions.size());
+
+        EULER_KERNEL_SCOPE("mesh::computeVertexNormals", V::kPath, indices.size() / 3,
+            indices.size() * (sizeof(uint32_t) * 2 + sizeof(vec3f) + sizeof(float) * 8) + positions.size() * (sizeof(vec3f) + sizeof(float) * 4));
+
+        auto addTerms = [&](size_t begin, size_t end, vfloat4* sums, uint32_t first)
+        {
+            detail::addNormalTerms<weight, V>(positions, indices, begin, end, sums, first);
+        };
+
+        detail::sumCorners(indices, positions.size(), threadCount, addTerms, [&](size_t first, size_t count, const vfloat4* sums)
+        {
+            for (size_t i = 0; i < count; i += size_t(V::kWidth))
+            {
+                const size_t v = first + i, lanes = std::min(size_t(V::kWidth), count - i);
+
+                V n[3];
+                detail::gatherRows([&](size_t l) { return l < lanes ? detail::loadSum(sums[i + l]) : _mm_setzero_ps(); }, n);
+                detail::normalize3(n);
+
+                // Three floats a vertex, leaving the next one, maybe another thread's, alone.
+                detail::scatterRows({ n[0], n[1], n[2], V::zero() }, [&](size_t l, __m128 row)
+                {
+                    if (l < lanes)
+                    {
+                        float* out = reinterpret_cast<float*>(&normals[v + l]);
+                        _mm_storel_pi(reinterpret_cast<__m64*>(out), row);
+                        _mm_store_ss(out + 2, _mm_movehl_ps(row, row));
+                    }
+                });
+            }
+        });
+    }
+
+    // Tangent of every vertex from unit vertex normals and uvs, MikkTSpace style with angle
+    // weights. xyz is the unit tangent along increasing u, w = +-1 with bitangent =
+    // w * cross(normal, tangent).
+    // One tangent frame per vertex: split vertices on uv seams and mirrored uv islands
+    // before calling, as the index buffers of a cooked mesh already are. Vertices without a
+    // usable uv direction get an arbitrary tangent orthogonal to the normal.
+    template<tangentWeight weight = tangentWeight::angle, typename V = vfloatn>
+    inline void computeTangents(std::span<const vec3f> positions, std::span<const vec3f> normals, std::span<const vec2f> uvs,
+        std::span<const uint32_t> indices, std::span<vec4f> tangents, uint32_t threadCount = 1)
+    {
+        assert(normals.size() >= positions.size() && uvs.size() >= positions.size() && tangents.size() >= positions.size());
+
+        EULER_KERNEL_SCOPE("mesh::computeTangents", V::kPath, indices.size() / 3,
+            indices.size() * (sizeof(uint32_t) * 2 + sizeof(vec3f) * 2 + sizeof(vec2f) + sizeof(float) * 8) +
+            positions.size() * (sizeof(vec3f) + sizeof(vec4f) + sizeof(float) * 4));
+
+        auto addTerms = [&](size_t begin, size_t end, vfloat4* sums, uint32_t first)
+        {
+            detail::addTangentTerms<weight, V>(positions, normals, uvs, indices, begin, end, sums, first);
+        };
+
+        auto finish = [&](size_t first, size_t count, const vfloat4* sums)
+        {
+            const V zero = V::zero(), one(1.0f);
+            for (size_t i = 0; i < count; i += size_t(V::kWidth))
+            {
+                const size_t v = first + i, lanes = std::min(size_t(V::kWidth), count - i);
+
+                V s[4], n[3];
+                detail::gatherRows([&](size_t l) { return l < lanes ? detail::loadSum(sums[i + l]) : _mm_setzero_ps(); }, s);
+                detail::gatherRows([&](size_t l) { return l < lanes ? detail::loadRow(normals, uint32_t(v + l)) : _mm_setzero_ps(); }, n);
+
+                V t[3] = { s[0], s[1], s[2] };
+                detail::project3(n, t);
+                const V usable = detail::dot3(t, t) > zero;
+                detail::normalize3(t);
+
+                // Fallback frame of Duff et al., "Building an orthonormal basis, revisited".
+                if (!all(usable))
+                {
+                    const V sign = select(n[2] >= zero, one, -one);
+                    const V a = -one / (sign + n[2]);
+                    const V b = n[0] * n[1] * a;
+                    t[0] = select(usable, t[0], one + sign * n[0] * n[0] * a);
+                    t[1] = select(usable, t[1], sign * b);
+                    t[2] = select(usable, t[2], -sign * n[0]);
+                }
+
+                detail::scatterRows({ t[0], t[1], t[2], select(s[3] >= zero, one, -one) }, [&](size_t l, __m128 row)
+                {
+                    if (l < lanes)
+                    {
+                        _mm_storeu_ps(reinterpret_cast<float*>(&tangents[v + l]), row);
+                    }
+                });
+            }
+        };
+
+        // Four lanes do not pay for the transposes of the face terms, so that case is the
+        // classic loop adding each face straight into the output, on one thread, before the
+        // same finish.
+        if constexpr (weight == tangentWeight::face && V::kWidth == 4)
+        {
+            std::fill(tangents.begin(), tangents.begin() + positions.size(), vec4f(0.0f));
+            for (size_t t = 0; t < indices.size(); t += 3)
+            {
+                const __m128 term = detail::faceTangentTerm(detail::faceTangentRow(positions, uvs, &indices[t]));
+                for (int32_t k = 0; k < 3; k++)
+                {
+                    float* sum = reinterpret_cast<float*>(&tangents[indices[t + k]]);
+                    _mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), term));
+                }
+            }
+
+            vfloat4 block[detail::kMeshGrain];
+            for (size_t v = 0; v < positions.size(); v += detail::kMeshGrain)
+            {
+                const size_t count = std::min(detail::kMeshGrain, positions.size() - v);
+                for (size_t i = 0; i < count; i++)
+                {
+                    block[i] = vfloat4(_mm_loadu_ps(reinterpret_cast<const float*>(&tangents[v + i])));
+                }
+                finish(v, count, block);
+            }
+            return;
+        }
+
+        detail::sumCorners(indices, positions.size(), threadCount, addTerms, finish);
+    }
+}
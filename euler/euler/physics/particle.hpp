@@ -0,0 +1,461 @@
+#pragma once
+#include <cstdint>
+#include <cassert>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "../scalar/tvec3.hpp"
+#include "../simd/vfloat4.hpp"
+#include "../core/soa.hpp"
+#include "../core/parallel.hpp"
+#include "../core/instrument.hpp"
+
+namespace euler
+{
+    enum class integrator
+    {
+        explicitEuler,      // p += v dt, v += a dt, both from the old state.
+        semiImplicitEuler,  // v += a dt, then p += v dt with the new velocity.
+        velocityVerlet,     // Second order, keeps the last acceleration in its own stream.
+        rk4,                // Fourth order Runge-Kutta, four force evaluations per step.
+    };
+
+    // Particle state as SoA streams of equal length. `acceleration` is only needed by
+    // velocityVerlet and `life` is optional; when present it is decreased by dt in the
+    // same pass and particles at or below zero are dead until compacted away.
+    struct particleStreams
+    {
+        soa3f position;
+        soa3f velocity;
+        soa3f acceleration;
+        std::span<float> life;
+    };
+
+    // Forces are functors over four particles at a time that add their acceleration:
+    //   void operator()(const vfloat4 (&p)[3], const vfloat4 (&v)[3], vfloat4 (&a)[3]) const;
+    // They run inside the integration pass, so no separate force stream is written.
+
+    struct gravityForce
+    {
+        vec3f gravity;
+
+        inline void operator()(const vfloat4 (&)[3], const vfloat4 (&)[3], vfloat4 (&a)[3]) const
+        {
+            a[0] += vfloat4(gravity.getX());
+            a[1] += vfloat4(gravity.getY());
+            a[2] += vfloat4(gravity.getZ());
+        }
+    };
+
+    // Linear drag, a -= k v.
+    struct dragForce
+    {
+        float k;
+
+        inline void operator()(const vfloat4 (&)[3], const vfloat4 (&v)[3], vfloat4 (&a)[3]) const
+        {
+            const vfloat4 nk(-k);
+            a[0] = madd(v[0], nk, a[0]);
+            a[1] = madd(v[1], nk, a[1]);
+            a[2] = madd(v[2], nk, a[2]);
+        }
+    };
+
+    // Inverse square pull towards `center`, softened to stay finite at the centre.
+    struct attractorForce
+    {
+        vec3f center;
+        float strength;
+        float softening = 1e-2f;
+
+        inline void operator()(const vfloat4 (&p)[3], const vfloat4 (&)[3], vfloat4 (&a)[3]) const
+        {
+            const vfloat4 dx = vfloat4(center.getX()) - p[0];
+            const vfloat4 dy = vfloat4(center.getY()) - p[1];
+            const vfloat4 dz = vfloat4(center.getZ()) - p[2];
+
+            const vfloat4 d2 = dx * dx + dy * dy + dz * dz + vfloat4(softening);
+            const vfloat4 scale = vfloat4(strength) / (d2 * sqrt(d2));
+
+            a[0] = madd(dx, scale, a[0]);
+            a[1] = madd(dy, scale, a[1]);
+            a[2] = madd(dz, scale, a[2]);
+        }
+    };
+
+    // Sum of several forces, evaluated in order in the same pass.
+    template<typename... Forces>
+    struct forceSet
+    {
+        std::tuple<Forces...> forces;
+
+        inline void operator()(const vfloat4 (&p)[3], const vfloat4 (&v)[3], vfloat4 (&a)[3]) const
+        {
+            std::apply([&](const Forces&... force) { (force(p, v, a), ...); }, forces);
+        }
+    };
+
+    template<typename... Forces>
+    inline forceSet<Forces...> combineForces(const Forces&... forces)
+    {
+        return forceSet<Forces...> { std::tuple<Forces...>(forces...) };
+    }
+
+    constexpr size_t kParticleGrain = 1 << 14;
+
+    namespace detail
+    {
+        // Four particles worth of one soa3f stream, tails padded through a local copy.
+        struct particleLanes
+        {
+            vfloat4 v[3];
+
+            inline void load(const soa3f& s, size_t i, size_t lanes)
+            {
+                if (lanes == 4)
+                {
+                    v[0] = vfloat4::load(&s.x()[i]);
+                    v[1] = vfloat4::load(&s.y()[i]);
+                    v[2] = vfloat4::load(&s.z()[i]);
+                    return;
+                }
+
+                alignas(16) float c[3][4] = { };
+                for (size_t l = 0; l < lanes; l++)
+                {
+                    c[0][l] = s.x()[i + l];
+                    c[1][l] = s.y()[i + l];
+                    c[2][l] = s.z()[i + l];
+                }
+                v[0] = vfloat4::loadAligned(c[0]);
+                v[1] = vfloat4::loadAligned(c[1]);
+                v[2] = vfloat4::loadAligned(c[2]);
+            }
+
+            inline void store(const soa3f& s, size_t i, size_t lanes) const
+            {
+                if (lanes == 4)
+                {
+                    v[0].store(&s.x()[i]);
+                    v[1].store(&s.y()[i]);
+                    v[2].store(&s.z()[i]);
+                    return;
+                }
+
+                alignas(16) float c[3][4];
+                v[0].storeAligned(c[0]);
+                v[1].storeAligned(c[1]);
+                v[2].storeAligned(c[2]);
+                for (size_t l = 0; l < lanes; l++)
+                {
+                    s.x()[i + l] = c[0][l];
+                    s.y()[i + l] = c[1][l];
+                    s.z()[i + l] = c[2][l];
+                }
+            }
+        };
+
+        template<typename Force>
+        inline void accelerate(const Force& force, const vfloat4 (&p)[3], const vfloat4 (&v)[3], vfloat4 (&a)[3])
+        {
+            a[0] = vfloat4::zero();
+            a[1] = vfloat4::zero();
+            a[2] = vfloat4::zero();
+            force(p, v, a);
+        }
+
+        // out = base + d * h.
+        inline void step(const vfloat4 (&base)[3], const vfloat4 (&d)[3], const vfloat4& h, vfloat4 (&out)[3])
+        {
+            out[0] = madd(d[0], h, base[0]);
+            out[1] = madd(d[1], h, base[1]);
+            out[2] = madd(d[2], h, base[2]);
+        }
+
+        template<integrator method, typename Force>
+        inline void integrateLanes(vfloat4 (&p)[3], vfloat4 (&v)[3], vfloat4 (&acc)[3], const vfloat4& h, const Force& force)
+        {
+            if constexpr (method == integrator::explicitEuler)
+            {
+                vfloat4 a[3];
+                accelerate(force, p, v, a);
+                step(p, v, h, p);
+                step(v, a, h, v);
+            }
+            else if constexpr (method == integrator::semiImplicitEuler)
+            {
+                vfloat4 a[3];
+                accelerate(force, p, v, a);
+                step(v, a, h, v);
+                step(p, v, h, p);
+            }
+            else if constexpr (method == integrator::velocityVerlet)
+            {
+                // p += v h + a h^2 / 2, then average the old and new acceleration. Velocity
+                // dependent forces see the explicit prediction v + a h.
+                const vfloat4 halfH = h * vfloat4(0.5f);
+
+                vfloat4 drift[3];
+                step(v, acc, halfH, drift);
+                step(p, drift, h, p);
+
+                vfloat4 predicted[3], a[3];
+                step(v, acc, h, predicted);
+                accelerate(force, p, predicted, a);
+
+                vfloat4 sum[3] = { acc[0] + a[0], acc[1] + a[1], acc[2] + a[2] };
+                step(v, sum, halfH, v);
+
+                acc[0] = a[0];
+                acc[1] = a[1];
+                acc[2] = a[2];
+            }
+            else
+            {
+                const vfloat4 halfH = h * vfloat4(0.5f);
+
+                vfloat4 p2[3], v2[3], p3[3], v3[3], p4[3], v4[3];
+                vfloat4 a1[3], a2[3], a3[3], a4[3];
+
+                accelerate(force, p, v, a1);
+
+                step(p, v, halfH, p2);
+                step(v, a1, halfH, v2);
+                accelerate(force, p2, v2, a2);
+
+                step(p, v2, halfH, p3);
+                step(v, a2, halfH, v3);
+                accelerate(force, p3, v3, a3);
+
+                step(p, v3, h, p4);
+                step(v, a3, h, v4);
+                accelerate(force, p4, v4, a4);
+
+                const vfloat4 two(2.0f);
+                const vfloat4 sixthH = h * vfloat4(1.0f / 6.0f);
+                for (int32_t c = 0; c < 3; c++)
+                {
+                    p[c] = madd(v[c] + two * (v2[c] + v3[c]) + v4[c], sixthH, p[c]);
+                    v[c] = madd(a1[c] + two * (a2[c] + a3[c]) + a4[c], sixthH, v[c]);
+                }
+            }
+        }
+
+        inline void ageLanes(std::span<float> life, size_t i, size_t lanes, float dt)
+        {
+            for (size_t l = 0; l < lanes; l++)
+            {
+                life[i + l] -= dt;
+            }
+        }
+    }
+
+    // Evaluates the force at the current state into the acceleration stream. velocityVerlet
+    // starts each step from the acceleration the previous step left there, so streams
+    // integrated directly need this before their first step; particleSystem primes itself.
+    template<typename Force>
+    inline void primeAcceleration(const particleStreams& particles, const Force& force, uint32_t threadCount = 1)
+    {
+        const size_t count = particles.position.size();
+        assert(particles.velocity.size() >= count && particles.acceleration.size() >= count);
+
+        EULER_KERNEL_SCOPE("particle::primeAcceleration", vfloat4::kPath, count, count * sizeof(float) * 9);
+
+        parallelFor(count, kParticleGrain, threadCount, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i += 4)
+            {
+                const size_t lanes = std::min<size_t>(4, end - i);
+
+                detail::particleLanes p, v, a;
+                p.load(particles.position, i, lanes);
+                v.load(particles.velocity, i, lanes);
+                detail::accelerate(force, p.v, v.v, a.v);
+                a.store(particles.acceleration, i, lanes);
+            }
+        });
+    }
+
+    // Advances every particle by dt in one fused pass: forces, integration and ageing.
+    // velocityVerlet expects a primed acceleration stream, see primeAcceleration.
+    template<integrator method, typename Force>
+    inline void integrate(const particleStreams& particles, float dt, const Force& force, uint32_t threadCount = 1)
+    {
+        const size_t count = particles.position.size();
+        assert(particles.velocity.size() >= count);
+        assert(method != integrator::velocityVerlet || particles.acceleration.size() >= count);
+        assert(particles.life.empty() || particles.life.size() >= count);
+
+        EULER_KERNEL_SCOPE("particle::integrate", vfloat4::kPath, count,
+            count * sizeof(float) * (12 + (method == integrator::velocityVerlet ? 6 : 0) + (particles.life.empty() ? 0 : 2)));
+
+        const vfloat4 h(dt);
+
+        parallelFor(count, kParticleGrain, threadCount, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i += 4)
+            {
+                const size_t lanes = std::min<size_t>(4, end - i);
+
+                detail::particleLanes p, v, a;
+                p.load(particles.position, i, lanes);
+                v.load(particles.velocity, i, lanes);
+                if constexpr (method == integrator::velocityVerlet)
+                {
+                    a.load(particles.acceleration, i, lanes);
+                }
+
+                detail::integrateLanes<method>(p.v, v.v, a.v, h, force);
+
+                p.store(particles.position, i, lanes);
+                v.store(particles.velocity, i, lanes);
+                if constexpr (method == integrator::velocityVerlet)
+                {
+                    a.store(particles.acceleration, i, lanes);
+                }
+
+                if (particles.life.empty())
+                {
+                    continue;
+                }
+                if (lanes == 4)
+                {
+                    (vfloat4::load(&particles.life[i]) - h).store(&particles.life[i]);
+                }
+                else
+                {
+                    detail::ageLanes(particles.life, i, lanes, dt);
+                }
+            }
+        });
+    }
+
+    // Owning SoA particle storage with stable dead particle compaction.
+    class particleSystem
+    {
+    public:
+        explicit particleSystem() = default;
+
+        inline size_t size() const { return m_life.size(); }
+
+        inline void reserve(size_t count)
+        {
+            for (std::vector<float>& stream : m_streams)
+            {
+                stream.reserve(count);
+            }
+            m_life.reserve(count);
+        }
+
+        inline void add(const vec3f& position, const vec3f& velocity, float life)
+        {
+            push(kPosition, position);
+            push(kVelocity, velocity);
+            push(kAcceleration, vec3f(0.0f));
+            m_life.push_back(life);
+        }
+
+        inline soa3f positions()     { return stream(kPosition); }
+        inline soa3f velocities()    { return stream(kVelocity); }
+        inline soa3f accelerations() { return stream(kAcceleration); }
+        inline std::span<float> life() { return m_life; }
+
+        inline particleStreams streams()
+        {
+            return particleStreams { positions(), velocities(), accelerations(), m_life };
+        }
+
+        // velocityVerlet first primes the accelerations of particles added since its last
+        // step, any other integrator leaves the acceleration stream stale.
+        template<integrator method, typename Force>
+        inline void step(float dt, const Force& force, uint32_t threadCount = 1)
+        {
+            particleStreams particles = streams();
+            if constexpr (method == integrator::velocityVerlet)
+            {
+                if (m_primed < size())
+                {
+                    const size_t count = size() - m_primed;
+                    primeAcceleration(particleStreams { particles.position.subspan(m_primed, count),
+                        particles.velocity.subspan(m_primed, count), particles.acceleration.subspan(m_primed, count), particles.life.subspan(m_primed, count) },
+                        force, threadCount);
+                }
+                m_primed = size();
+            }
+            else
+            {
+                particles.acceleration = soa3f();
+                m_primed = 0;
+            }
+            integrate<method>(particles, dt, force, threadCount);
+        }
+
+        // Removes particles whose life reached zero, keeping the order of the survivors.
+        // Returns the number removed.
+        inline size_t compact()
+        {
+            EULER_KERNEL_SCOPE("particle::compact", isa::scalar, size(), size() * sizeof(float) * 10);
+
+            const size_t count = size();
+            const vfloat4 zero = vfloat4::zero();
+
+            // Skip the leading run of live particles four at a time.
+            size_t write = 0;
+            while (write + 4 <= count && all(vfloat4::load(&m_life[write]) > zero))
+            {
+                write += 4;
+            }
+
+            // Survivors keep their order, so the primed ones stay in front.
+            size_t primed = std::min(write, m_primed);
+            for (size_t read = write; read < count; read++)
+            {
+                if (m_life[read] > 0.0f)
+                {
+                    primed += read < m_primed ? 1 : 0;
+                    for (std::vector<float>& stream : m_streams)
+                    {
+                        stream[write] = stream[read];
+                    }
+                    m_life[write] = m_life[read];
+                    write++;
+                }
+            }
+
+            for (std::vector<float>& stream : m_streams)
+            {
+                stream.resize(write);
+            }
+            m_life.resize(write);
+            m_primed = primed;
+
+            return count - write;
+        }
+
+    private:
+        static constexpr size_t kPosition = 0;
+        static constexpr size_t kVelocity = 3;
+        static constexpr size_t kAcceleration = 6;
+
+        inline void push(size_t first, const vec3f& v)
+        {
+            m_streams[first + 0].push_back(v.getX());
+            m_streams[first + 1].push_back(v.getY());
+            m_streams[first + 2].push_back(v.getZ());
+        }
+
+        inline soa3f stream(size_t first)
+        {
+            return soa3f(m_streams[first], m_streams[first + 1], m_streams[first + 2]);
+        }
+
+    private:
+        // Position, velocity and acceleration components.
+        std::vector<float> m_streams[9];
+        std::vector<float> m_life;
+
+        // Leading particles whose acceleration holds the force of their current state.
+        size_t m_primed = 0;
+    };
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+#include "../scalar/tvec2.hpp"
+#include "../scalar/tvec4.hpp"
+#include "../simd/vfloat4.hpp"
+
+namespace euler
+{
+    // Philox4x32-10 counter based generator (Salmon et al., "Parallel random numbers:
+    // as easy as 1, 2, 3"). Output is a pure function of counter and key, so a stream
+    // can be split over lanes and threads in any way and still give the same numbers.
+    constexpr uint32_t kPhiloxM0 = 0xD2511F53u;
+    constexpr uint32_t kPhiloxM1 = 0xCD9E8D57u;
+    constexpr uint32_t kPhiloxW0 = 0x9E3779B9u;
+    constexpr uint32_t kPhiloxW1 = 0xBB67AE85u;
+
+    inline vec4u philox4x32(const vec4u& counter, const vec2u& key)
+    {
+        uint32_t c0 = counter.getX(), c1 = counter.getY(), c2 = counter.getZ(), c3 = counter.getW();
+        uint32_t k0 = key.getX(), k1 = key.getY();
+
+        for (int32_t round = 0; round < 10; round++)
+        {
+            const uint64_t p0 = uint64_t(kPhiloxM0) * c0;
+            const uint64_t p1 = uint64_t(kPhiloxM1) * c2;
+
+            const uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+            const uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+
+            c1 = uint32_t(p1);
+            c3 = uint32_t(p0);
+            c0 = n0;
+            c2 = n2;
+
+            k0 += kPhiloxW0;
+            k1 += kPhiloxW1;
+        }
+
+        return vec4u(c0, c1, c2, c3);
+    }
+
+    // Four generators in parallel, word w of every lane's counter and result in words[w].
+    inline void philox4x32(__m128i (&words)[4], const vec2u& key)
+    {
+        const __m128i m0 = _mm_set1_epi32(int32_t(kPhiloxM0));
+        const __m128i m1 = _mm_set1_epi32(int32_t(kPhiloxM1));
+        const __m128i lowHalves  = _mm_set_epi32(0, -1, 0, -1);
+
+        __m128i k0 = _mm_set1_epi32(int32_t(key.getX()));
+        __m128i k1 = _mm_set1_epi32(int32_t(key.getY()));
+
+        for (int32_t round = 0; round < 10; round++)
+        {
+            // 32x32 -> 64 bit products of the even lanes, then of the odd lanes.
+            const __m128i p0even = _mm_mul_epu32(words[0], m0);
+            const __m128i p0odd  = _mm_mul_epu32(_mm_srli_epi64(words[0], 32), m0);
+            const __m128i p1even = _mm_mul_epu32(words[2], m1);
+            const __m128i p1odd  = _mm_mul_epu32(_mm_srli_epi64(words[2], 32), m1);
+
+            const __m128i lo0 = _mm_or_si128(_mm_and_si128(p0even, lowHalves), _mm_slli_epi64(p0odd, 32));
+            const __m128i hi0 = _mm_or_si128(_mm_srli_epi64(p0even, 32), _mm_andnot_si128(lowHalves, p0odd));
+            const __m128i lo1 = _mm_or_si128(_mm_and_si128(p1even, lowHalves), _mm_slli_epi64(p1odd, 32));
+            const __m128i hi1 = _mm_or_si128(_mm_srli_epi64(p1even, 32), _mm_andnot_si128(lowHalves, p1odd));
+
+            const __m128i n0 = _mm_xor_si128(_mm_xor_si128(hi1, words[1]), k0);
+            const __m128i n2 = _mm_xor_si128(_mm_xor_si128(hi0, words[3]), k1);
+
+            words[0] = n0;
+            words[1] = lo1;
+            words[2] = n2;
+            words[3] = lo0;
+
+            k0 = _mm_add_epi32(k0, _mm_set1_epi32(int32_t(kPhiloxW0)));
+            k1 = _mm_add_epi32(k1, _mm_set1_epi32(int32_t(kPhiloxW1)));
+        }
+    }
+
+    // Generator key of a 64 bit seed.
+    inline vec2u philoxKey(uint64_t seed) { return vec2u(uint32_t(seed), uint32_t(seed >> 32)); }
+
+    // Counter of sample `index` in stream `stream`.
+    inline vec4u philoxCounter(uint64_t index, uint32_t stream)
+    {
+        return vec4u(uint32_t(index), uint32_t(index >> 32), stream, 0);
+    }
+
+    // Counters of samples index .. index + 3.
+    inline void philoxCounters(uint64_t index, uint32_t stream, __m128i (&words)[4])
+    {
+        words[0] = _mm_setr_epi32(int32_t(uint32_t(index)), int32_t(uint32_t(index + 1)),
+                                  int32_t(uint32_t(index + 2)), int32_t(uint32_t(index + 3)));
+        words[1] = _mm_setr_epi32(int32_t(uint32_t(index >> 32)), int32_t(uint32_t((index + 1) >> 32)),
+                                  int32_t(uint32_t((index + 2) >> 32)), int32_t(uint32_t((index + 3) >> 32)));
+        words[2] = _mm_set1_epi32(int32_t(stream));
+        words[3] = _mm_setzero_si128();
+    }
+
+    // Uniform float in [0, 1) from the top 24 bits, exact in both forms.
+    inline float uniformFloat(uint32_t bits)
+    {
+        return float(bits >> 8) * (1.0f / 16777216.0f);
+    }
+
+    inline vfloat4 uniformFloat(__m128i bits)
+    {
+        return vfloat4(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)), _mm_set1_ps(1.0f / 16777216.0f)));
+    }
+}
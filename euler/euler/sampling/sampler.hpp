@@ -0,0 +1,370 @@
+#pragma once
+#include <cstdint>
+#include <cassert>
+#include <span>
+
+#include "../scalar/tvec2.hpp"
+#include "../scalar/tvec3.hpp"
+#include "../simd/vfloat4.hpp"
+#include "../core/parallel.hpp"
+#include "../core/instrument.hpp"
+#include "random.hpp"
+
+namespace euler
+{
+    // Bulk samplers. Random samplers give sample i from philox4x32 of counter
+    // (firstIndex + i, sampler stream), and every sample, tail included, is computed by
+    // the same four lane kernel, so the output depends only on seed and index and not
+    // on how the range is split over calls or threads.
+
+    // Philox stream word of each sampler, keeps their outputs uncorrelated for one seed.
+    enum class samplerStream : uint32_t
+    {
+        uniform = 0,
+        disk,
+        sphere,
+        cosineHemisphere,
+        sobolScramble,
+    };
+
+    constexpr size_t kSamplerGrain = 1 << 14;
+
+    // Warps of four uniform [0, 1) pairs, the building blocks of the bulk samplers. No
+    // product is fused, so a seed gives the same bits on every ISA build.
+
+    // Shirley-Chiu concentric map, keeps the stratification of its input.
+    inline void warpToDisk(const vfloat4& u0, const vfloat4& u1, vfloat4& x, vfloat4& y)
+    {
+        const vfloat4 quarterPi(0.78539816339744831f);
+
+        const vfloat4 a = maddUnfused(u0, vfloat4(2.0f), vfloat4(-1.0f));
+        const vfloat4 b = maddUnfused(u1, vfloat4(2.0f), vfloat4(-1.0f));
+
+        const vfloat4 useA = abs(a) > abs(b);
+        const vfloat4 r = select(useA, a, b);
+
+        // r is zero only at the centre, where the angle does not matter.
+        const vfloat4 safeR = select(abs(r) > vfloat4::zero(), r, vfloat4(1.0f));
+        const vfloat4 phi = select(useA, quarterPi * (b / safeR), quarterPi * (vfloat4(2.0f) - a / safeR));
+
+        vfloat4 s, c;
+        sincos(phi, s, c);
+
+        x = r * c;
+        y = r * s;
+    }
+
+    inline void warpToSphere(const vfloat4& u0, const vfloat4& u1, vfloat4& x, vfloat4& y, vfloat4& z)
+    {
+        z = vfloat4(1.0f) - mulUnfused(u0, vfloat4(2.0f));
+        const vfloat4 r = sqrt(max(vfloat4(1.0f) - mulUnfused(z, z), vfloat4::zero()));
+
+        vfloat4 s, c;
+        sincos(u1 * vfloat4(6.28318530717958648f), s, c);
+
+        x = r * c;
+        y = r * s;
+    }
+
+    // Malley's method, directions around +z with density cos(theta) / pi.
+    inline void warpToCosineHemisphere(const vfloat4& u0, const vfloat4& u1, vfloat4& x, vfloat4& y, vfloat4& z)
+    {
+        warpToDisk(u0, u1, x, y);
+        z = sqrt(max(vfloat4(1.0f) - mulUnfused(x, x) - mulUnfused(y, y), vfloat4::zero()));
+    }
+
+    namespace detail
+    {
+        inline void storeLanes(std::span<float> out, size_t index, size_t count, const vfloat4& v)
+        {
+            if (count == 4)
+            {
+                v.store(&out[index]);
+                return;
+            }
+
+            alignas(16) float lanes[4];
+            v.storeAligned(lanes);
+            for (size_t l = 0; l < count; l++)
+            {
+                out[index + l] = lanes[l];
+            }
+        }
+
+        inline void storeLanes(std::span<tvec2<float>> out, size_t index, size_t count, const vfloat4& x, const vfloat4& y)
+        {
+            alignas(16) float lx[4], ly[4];
+            x.storeAligned(lx);
+            y.storeAligned(ly);
+            for (size_t l = 0; l < count; l++)
+            {
+                out[index + l] = tvec2<float>(lx[l], ly[l]);
+            }
+        }
+
+        inline void storeLanes(std::span<tvec3<float>> out, size_t index, size_t count, const vfloat4& x, const vfloat4& y, const vfloat4& z)
+        {
+            alignas(16) float lx[4], ly[4], lz[4];
+            x.storeAligned(lx);
+            y.storeAligned(ly);
+            z.storeAligned(lz);
+            for (size_t l = 0; l < count; l++)
+            {
+                out[index + l] = tvec3<float>(lx[l], ly[l], lz[l]);
+            }
+        }
+
+        inline void loadLanes(std::span<const tvec2<float>> in, size_t index, size_t count, vfloat4& x, vfloat4& y)
+        {
+            alignas(16) float lx[4] = { }, ly[4] = { };
+            for (size_t l = 0; l < count; l++)
+            {
+                lx[l] = in[index + l].getX();
+                ly[l] = in[index + l].getY();
+            }
+            x = vfloat4::loadAligned(lx);
+            y = vfloat4::loadAligned(ly);
+        }
+
+        // Runs kernel(index, lanes, words) for every group of four samples, words holding
+        // the philox output of samples index .. index + lanes - 1.
+        template<typename Kernel>
+        inline void generate(size_t count, uint64_t seed, uint64_t firstIndex, samplerStream stream, uint32_t threadCount, Kernel&& kernel)
+        {
+            const vec2u key = philoxKey(seed);
+
+            parallelFor(count, kSamplerGrain, threadCount, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i += 4)
+                {
+                    __m128i words[4];
+                    philoxCounters(firstIndex + i, static_cast<uint32_t>(stream), words);
+                    philox4x32(words, key);
+
+                    kernel(i, std::min<size_t>(4, end - i), words);
+                }
+            });
+        }
+    }
+
+    // Uniform floats in [0, 1).
+    inline void sampleUniform(std::span<float> out, uint64_t seed, uint64_t firstIndex = 0, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("sampling::uniform", vfloat4::kPath, out.size(), out.size() * sizeof(float));
+
+        detail::generate(out.size(), seed, firstIndex, samplerStream::uniform, threadCount,
+            [&](size_t index, size_t lanes, const __m128i (&words)[4])
+        {
+            detail::storeLanes(out, index, lanes, uniformFloat(words[0]));
+        });
+    }
+
+    // Uniform points on the unit disk.
+    inline void sampleUniformDisk(std::span<tvec2<float>> out, uint64_t seed, uint64_t firstIndex = 0, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("sampling::uniformDisk", vfloat4::kPath, out.size(), out.size() * sizeof(tvec2<float>));
+
+        detail::generate(out.size(), seed, firstIndex, samplerStream::disk, threadCount,
+            [&](size_t index, size_t lanes, const __m128i (&words)[4])
+        {
+            vfloat4 x, y;
+            warpToDisk(uniformFloat(words[0]), uniformFloat(words[1]), x, y);
+            detail::storeLanes(out, index, lanes, x, y);
+        });
+    }
+
+    // Uniform directions on the unit sphere.
+    inline void sampleUnitSphere(std::span<tvec3<float>> out, uint64_t seed, uint64_t firstIndex = 0, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("sampling::unitSphere", vfloat4::kPath, out.size(), out.size() * sizeof(tvec3<float>));
+
+        detail::generate(out.size(), seed, firstIndex, samplerStream::sphere, threadCount,
+            [&](size_t index, size_t lanes, const __m128i (&words)[4])
+        {
+            vfloat4 x, y, z;
+            warpToSphere(uniformFloat(words[0]), uniformFloat(words[1]), x, y, z);
+            detail::storeLanes(out, index, lanes, x, y, z);
+        });
+    }
+
+    // Cosine weighted directions on the hemisphere around +z.
+    inline void sampleCosineHemisphere(std::span<tvec3<float>> out, uint64_t seed, uint64_t firstIndex = 0, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("sampling::cosineHemisphere", vfloat4::kPath, out.size(), out.size() * sizeof(tvec3<float>));
+
+        detail::generate(out.size(), seed, firstIndex, samplerStream::cosineHemisphere, threadCount,
+            [&](size_t index, size_t lanes, const __m128i (&words)[4])
+        {
+            vfloat4 x, y, z;
+            warpToCosineHemisphere(uniformFloat(words[0]), uniformFloat(words[1]), x, y, z);
+            detail::storeLanes(out, index, lanes, x, y, z);
+        });
+    }
+
+    // Low discrepancy sequences, points of index firstIndex + i.
+
+    inline uint32_t reverseBits(uint32_t v)
+    {
+        v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+        v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+        v = ((v >> 4) & 0x0f0f0f0fu) | ((v & 0x0f0f0f0fu) << 4);
+        v = ((v >> 8) & 0x00ff00ffu) | ((v & 0x00ff00ffu) << 8);
+        return (v >> 16) | (v << 16);
+    }
+
+    // Second dimension of the Sobol sequence, primitive polynomial x + 1.
+    inline uint32_t sobolDimension1(uint32_t index)
+    {
+        uint32_t result = 0;
+        for (uint32_t v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1)
+        {
+            if (index & 1)
+            {
+                result ^= v;
+            }
+        }
+        return result;
+    }
+
+    // Radical inverse of `index` in `base`, in [0, 1).
+    inline float radicalInverse(uint32_t index, uint32_t base)
+    {
+        uint64_t reversed = 0;
+        uint64_t scale = 1;
+        while (index != 0)
+        {
+            reversed = reversed * base + index % base;
+            scale *= base;
+            index /= base;
+        }
+
+        const float v = float(double(reversed) / double(scale));
+        return v < 1.0f ? v : 0.99999994f;
+    }
+
+    // First two Sobol dimensions, xor scrambled by random digits of `seed` (0 keeps
+    // the plain sequence). Scrambling preserves the (0, 2) net stratification.
+    inline void sampleSobol2D(std::span<tvec2<float>> out, uint64_t seed = 0, uint32_t firstIndex = 0, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("sampling::sobol2D", vfloat4::kPath, out.size(), out.size() * sizeof(tvec2<float>));
+
+        vec4u scramble(0);
+        if (seed != 0)
+        {
+            scramble = philox4x32(philoxCounter(0, static_cast<uint32_t>(samplerStream::sobolScramble)), philoxKey(seed));
+        }
+
+        // Direction numbers of both dimensions per index bit.
+        __m128i directions[32][2];
+        for (uint32_t b = 0, v = 1u << 31; b < 32; b++, v ^= v >> 1)
+        {
+            directions[b][0] = _mm_set1_epi32(int32_t(1u << (31 - b)));
+            directions[b][1] = _mm_set1_epi32(int32_t(v));
+        }
+
+        parallelFor(out.size(), kSamplerGrain, threadCount, [&](size_t begin, size_t end)
+        {
+            const __m128i one = _mm_set1_epi32(1);
+
+            for (size_t i = begin; i < end; i += 4)
+            {
+                const uint32_t index = firstIndex + uint32_t(i);
+                const __m128i indices = _mm_add_epi32(_mm_set1_epi32(int32_t(index)), _mm_setr_epi32(0, 1, 2, 3));
+
+                __m128i d0 = _mm_set1_epi32(int32_t(scramble.getX()));
+                __m128i d1 = _mm_set1_epi32(int32_t(scramble.getY()));
+
+                __m128i bits = indices;
+                for (uint32_t b = 0; b < 32 && (uint64_t(index) + 3) >> b != 0; b++)
+                {
+                    const __m128i mask = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(bits, one));
+                    d0 = _mm_xor_si128(d0, _mm_and_si128(mask, directions[b][0]));
+                    d1 = _mm_xor_si128(d1, _mm_and_si128(mask, directions[b][1]));
+                    bits = _mm_srli_epi32(bits, 1);
+                }
+
+                detail::storeLanes(out, i, std::min<size_t>(4, end - i), uniformFloat(d0), uniformFloat(d1));
+            }
+        });
+    }
+
+    // Halton sequence in bases 2 and 3.
+    inline void sampleHalton2D(std::span<tvec2<float>> out, uint32_t firstIndex = 0, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("sampling::halton2D", isa::scalar, out.size(), out.size() * sizeof(tvec2<float>));
+
+        parallelFor(out.size(), kSamplerGrain, threadCount, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const uint32_t index = firstIndex + uint32_t(i);
+                out[i] = tvec2<float>(uniformFloat(reverseBits(index)), radicalInverse(index, 3));
+            }
+        });
+    }
+
+    // Halton sequence in bases 2, 3 and 5.
+    inline void sampleHalton3D(std::span<tvec3<float>> out, uint32_t firstIndex = 0, uint32_t threadCount = 1)
+    {
+        EULER_KERNEL_SCOPE("sampling::halton3D", isa::scalar, out.size(), out.size() * sizeof(tvec3<float>));
+
+        parallelFor(out.size(), kSamplerGrain, threadCount, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const uint32_t index = firstIndex + uint32_t(i);
+                out[i] = tvec3<float>(uniformFloat(reverseBits(index)), radicalInverse(index, 3), radicalInverse(index, 5));
+            }
+        });
+    }
+
+    // Warps of precomputed [0, 1)^2 points, e.g. from the low discrepancy sequences.
+
+    inline void warpToDisk(std::span<const tvec2<float>> u, std::span<tvec2<float>> out)
+    {
+        assert(out.size() >= u.size());
+        EULER_KERNEL_SCOPE("sampling::warpToDisk", vfloat4::kPath, u.size(), u.size() * sizeof(tvec2<float>) * 2);
+
+        for (size_t i = 0; i < u.size(); i += 4)
+        {
+            const size_t lanes = std::min<size_t>(4, u.size() - i);
+
+            vfloat4 u0, u1, x, y;
+            detail::loadLanes(u, i, lanes, u0, u1);
+            warpToDisk(u0, u1, x, y);
+            detail::storeLanes(out, i, lanes, x, y);
+        }
+    }
+
+    inline void warpToSphere(std::span<const tvec2<float>> u, std::span<tvec3<float>> out)
+    {
+        assert(out.size() >= u.size());
+        EULER_KERNEL_SCOPE("sampling::warpToSphere", vfloat4::kPath, u.size(), u.size() * (sizeof(tvec2<float>) + sizeof(tvec3<float>)));
+
+        for (size_t i = 0; i < u.size(); i += 4)
+        {
+            const size_t lanes = std::min<size_t>(4, u.size() - i);
+
+            vfloat4 u0, u1, x, y, z;
+            detail::loadLanes(u, i, lanes, u0, u1);
+            warpToSphere(u0, u1, x, y, z);
+            detail::storeLanes(out, i, lanes, x, y, z);
+        }
+    }
+
+    inline void warpToCosineHemisphere(std::span<const tvec2<float>> u, std::span<tvec3<float>> out)
+    {
+        assert(out.size() >= u.size());
+        EULER_KERNEL_SCOPE("sampling::warpToCosineHemisphere", vfloat4::kPath, u.size(), u.size() * (sizeof(tvec2<float>) + sizeof(tvec3<float>)));
+
+        for (size_t i = 0; i < u.size(); i += 4)
+        {
+            const size_t lanes = std::min<size_t>(4, u.size() - i);
+
+            vfloat4 u0, u1, x, y, z;
+            detail::loadLanes(u, i, lanes, u0, u1);
+            warpToCosineHemisphere(u0, u1, x, y, z);
+            detail::storeLanes(out, i, lanes, x, y, z);
+        }
+    }
+}
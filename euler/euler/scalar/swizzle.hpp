@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace euler
+{
+    template<typename T> class tvec2;
+    template<typename T> class tvec3;
+    template<typename T> class tvec4;
+
+    namespace detail
+    {
+        template<typename T, size_t count> struct tswizzle;
+        template<typename T> struct tswizzle<T, 2> { using type = tvec2<T>; };
+        template<typename T> struct tswizzle<T, 3> { using type = tvec3<T>; };
+        template<typename T> struct tswizzle<T, 4> { using type = tvec4<T>; };
+    }
+
+    // swizzle<2, 0, 1>(v) == v.zxy(), resolved at compile time into plain component moves.
+    template<int32_t... indices, typename T>
+    inline auto swizzle(const tvec2<T>& v) { return v.template swizzle<indices...>(); }
+
+    template<int32_t... indices, typename T>
+    inline auto swizzle(const tvec3<T>& v) { return v.template swizzle<indices...>(); }
+
+    template<int32_t... indices, typename T>
+    inline auto swizzle(const tvec4<T>& v) { return v.template swizzle<indices...>(); }
+}
+
+// Shader style named swizzles of two to four components, v.xy() up to v.wwww(). Every name
+// over xyzw is declared in every vector and constrained away when it reads a component the
+// vector does not have. Expanded inside the class body, which provides kComponents and swizzle.
+#define EULER_SWIZZLE_NAME2(a, ia, b, ib) \
+    inline auto a##b() const requires (ia < kComponents && ib < kComponents) { return swizzle<ia, ib>(); }
+#define EULER_SWIZZLE_NAME3(a, ia, b, ib, c, ic) \
+    inline auto a##b##c() const requires (ia < kComponents && ib < kComponents && ic < kComponents) { return swizzle<ia, ib, ic>(); }
+#define EULER_SWIZZLE_NAME4(a, ia, b, ib, c, ic, d, id) \
+    inline auto a##b##c##d() const requires (ia < kComponents && ib < kComponents && ic < kComponents && id < kComponents) { return swizzle<ia, ib, ic, id>(); }
+
+// One macro per position, the preprocessor does not re-expand a macro inside itself.
+#define EULER_SWIZZLE_EACH_A(F) F(x, 0) F(y, 1) F(z, 2) F(w, 3)
+#define EULER_SWIZZLE_EACH_B(F, a, ia) F(a, ia, x, 0) F(a, ia, y, 1) F(a, ia, z, 2) F(a, ia, w, 3)
+#define EULER_SWIZZLE_EACH_C(F, a, ia, b, ib) F(a, ia, b, ib, x, 0) F(a, ia, b, ib, y, 1) F(a, ia, b, ib, z, 2) F(a, ia, b, ib, w, 3)
+#define EULER_SWIZZLE_EACH_D(F, a, ia, b, ib, c, ic) \
+    F(a, ia, b, ib, c, ic, x, 0) F(a, ia, b, ib, c, ic, y, 1) F(a, ia, b, ib, c, ic, z, 2) F(a, ia, b, ib, c, ic, w, 3)
+
+#define EULER_SWIZZLE_2B(a, ia) EULER_SWIZZLE_EACH_B(EULER_SWIZZLE_NAME2, a, ia)
+#define EULER_SWIZZLE_3C(a, ia, b, ib) EULER_SWIZZLE_EACH_C(EULER_SWIZZLE_NAME3, a, ia, b, ib)
+#define EULER_SWIZZLE_3B(a, ia) EULER_SWIZZLE_EACH_B(EULER_SWIZZLE_3C, a, ia)
+#define EULER_SWIZZLE_4D(a, ia, b, ib, c, ic) EULER_SWIZZLE_EACH_D(EULER_SWIZZLE_NAME4, a, ia, b, ib, c, ic)
+#define EULER_SWIZZLE_4C(a, ia, b, ib) EULER_SWIZZLE_EACH_C(EULER_SWIZZLE_4D, a, ia, b, ib)
+#define EULER_SWIZZLE_4B(a, ia) EULER_SWIZZLE_EACH_B(EULER_SWIZZLE_4C, a, ia)
+
+#define EULER_SWIZZLE_MEMBERS \
+    EULER_SWIZZLE_EACH_A(EULER_SWIZZLE_2B) \
+    EULER_SWIZZLE_EACH_A(EULER_SWIZZLE_3B) \
+    EULER_SWIZZLE_EACH_A(EULER_SWIZZLE_4B)
@@ -2,6 +2,10 @@
 #include <cstdint>
 #include <cmath>
 
+#include "swizzle.hpp"
+#include "tvec3.hpp"
+#include "tvec4.hpp"
+
 namespace euler
 {
     template<typename T>
@@ -10,6 +14,8 @@ namespace euler
     public:
         using vec2 = tvec2<T>;
 
+        static constexpr int32_t kComponents = 2;
+
         explicit tvec2() = default;
         explicit tvec2(T v) : m_x(v), m_y(v) { }
         explicit tvec2(T x, T y) : m_x(x), m_y(y) { }
@@ -43,6 +49,16 @@ namespace euler
 
         inline T get(int32_t index) const { return *(&m_x + index); }
 
+        // Components in the given order, swizzle<2, 0, 1>() == zxy().
+        template<int32_t... indices>
+        inline typename detail::tswizzle<T, sizeof...(indices)>::type swizzle() const
+        {
+            static_assert(((indices >= 0 && indices < 2) && ...) && "Don't swizzle over 2 in vec2!");
+            return typename detail::tswizzle<T, sizeof...(indices)>::type(*(&m_x + indices)...);
+        }
+
+        EULER_SWIZZLE_MEMBERS
+
         inline T& operator[](int32_t index) { return *(&m_x + index); }
         inline T  operator[](int32_t index) const { return *(&m_x + index); }
 
@@ -189,4 +205,4 @@ namespace euler
     using vec2d = tvec2<double>;
     using vec2i = tvec2<int32_t>;
     using vec2u = tvec2<uint32_t>;
-}
\ No newline at end of file
+}
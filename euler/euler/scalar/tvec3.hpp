@@ -2,6 +2,10 @@
 #include <cstdint>
 #include <cmath>
 
+#include "swizzle.hpp"
+#include "tvec2.hpp"
+#include "tvec4.hpp"
+
 namespace euler
 {
     template<typename T>
@@ -10,6 +14,8 @@ namespace euler
     public:
         using vec3 = tvec3<T>;
 
+        static constexpr int32_t kComponents = 3;
+
         explicit tvec3() = default;
         explicit tvec3(T v) : m_x(v), m_y(v), m_z(v) { }
         explicit tvec3(T x, T y, T z) : m_x(x), m_y(y), m_z(z) { }
@@ -45,6 +51,16 @@ namespace euler
 
         inline T get(int32_t index) const { return *(&m_x + index); }
 
+        // Components in the given order, swizzle<2, 0, 1>() == zxy().
+        template<int32_t... indices>
+        inline typename detail::tswizzle<T, sizeof...(indices)>::type swizzle() const
+        {
+            static_assert(((indices >= 0 && indices < 3) && ...) && "Don't swizzle over 3 in vec3!");
+            return typename detail::tswizzle<T, sizeof...(indices)>::type(*(&m_x + indices)...);
+        }
+
+        EULER_SWIZZLE_MEMBERS
+
         inline T& operator[](int32_t index) { return *(&m_x + index); }
         inline T  operator[](int32_t index) const { return *(&m_x + index); }
 
@@ -181,6 +197,15 @@ namespace euler
         return v0.getX() * v1.getX() + v0.getY() * v1.getY() + v0.getZ() * v1.getZ();
     }
 
+    template<typename T>
+    inline tvec3<T> cross(const tvec3<T>& v0, const tvec3<T>& v1)
+    {
+        return tvec3<T>(
+            v0.getY() * v1.getZ() - v0.getZ() * v1.getY(),
+            v0.getZ() * v1.getX() - v0.getX() * v1.getZ(),
+            v0.getX() * v1.getY() - v0.getY() * v1.getX());
+    }
+
     template<typename T>
     inline T lengthSquare(const tvec3<T>& v)
     {
@@ -208,4 +233,4 @@ namespace euler
     using vec3d = tvec3<double>;
     using vec3i = tvec3<int32_t>;
     using vec3u = tvec3<uint32_t>;
-}
\ No newline at end of file
+}
@@ -2,6 +2,10 @@
 #include <cstdint>
 #include <cmath>
 
+#include "swizzle.hpp"
+#include "tvec2.hpp"
+#include "tvec3.hpp"
+
 namespace euler
 {
     template<typename T>
@@ -10,6 +14,8 @@ namespace euler
     public:
         using vec4 = tvec4<T>;
 
+        static constexpr int32_t kComponents = 4;
+
         explicit tvec4() = default;
         explicit tvec4(T v) : m_x(v), m_y(v), m_z(v), m_w(v) { }
         explicit tvec4(T x, T y, T z, T w) : m_x(x), m_y(y), m_z(z), m_w(w) { }
@@ -47,6 +53,16 @@ namespace euler
 
         inline T get(int32_t index) const { return *(&m_x + index); }
 
+        // Components in the given order, swizzle<2, 0, 1>() == zxy().
+        template<int32_t... indices>
+        inline typename detail::tswizzle<T, sizeof...(indices)>::type swizzle() const
+        {
+            static_assert(((indices >= 0 && indices < 4) && ...) && "Don't swizzle over 4 in vec4!");
+            return typename detail::tswizzle<T, sizeof...(indices)>::type(*(&m_x + indices)...);
+        }
+
+        EULER_SWIZZLE_MEMBERS
+
         inline T& operator[](int32_t index) { return *(&m_x + index); }
         inline T  operator[](int32_t index) const { return *(&m_x + index); }
 
@@ -248,4 +264,4 @@ namespace euler
     using vec4d = tvec4<double>;
     using vec4i = tvec4<int32_t>;
     using vec4u = tvec4<uint32_t>;
-}
\ No newline at end of file
+}
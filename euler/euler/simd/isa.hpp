@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+
+namespace euler
+{
+    // Instruction set path a bulk kernel was dispatched to.
+    enum class isa : uint8_t
+    {
+        scalar = 0,
+        sse2,
+        sse41,
+        avx,
+        avx2,
+
+        count
+    };
+
+    inline const char* isaName(isa value)
+    {
+        switch (value)
+        {
+        case isa::scalar: return "scalar";
+        case isa::sse2:   return "sse2";
+        case isa::sse41:  return "sse4.1";
+        case isa::avx:    return "avx";
+        case isa::avx2:   return "avx2";
+        default:          return "unknown";
+        }
+    }
+
+    // Widest instruction set enabled for this translation unit by the compiler flags.
+#if defined(__AVX2__)
+    constexpr isa kCompiledIsa = isa::avx2;
+#elif defined(__AVX__)
+    constexpr isa kCompiledIsa = isa::avx;
+#elif defined(__SSE4_1__)
+    constexpr isa kCompiledIsa = isa::sse41;
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    constexpr isa kCompiledIsa = isa::sse2;
+#else
+    constexpr isa kCompiledIsa = isa::scalar;
+#endif
+}
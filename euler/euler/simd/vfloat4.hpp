@@ -0,0 +1,180 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#include <smmintrin.h>
+#endif
+
+#include "isa.hpp"
+
+namespace euler
+{
+    // Four float lanes in one SSE register, the building block of the bulk kernels.
+    // Comparisons return lane masks (all bits set when true) usable with select().
+    class vfloat4
+    {
+    public:
+        static constexpr int32_t kWidth = 4;
+        static constexpr isa kPath = kCompiledIsa >= isa::sse41 ? isa::sse41 : isa::sse2;
+
+        explicit vfloat4() = default;
+        explicit vfloat4(float v) : m_value(_mm_set1_ps(v)) { }
+        explicit vfloat4(float x, float y, float z, float w) : m_value(_mm_setr_ps(x, y, z, w)) { }
+        explicit vfloat4(__m128 v) : m_value(v) { }
+
+        inline static vfloat4 load(const float* ptr) { return vfloat4(_mm_loadu_ps(ptr)); }
+        inline static vfloat4 loadAligned(const float* ptr) { return vfloat4(_mm_load_ps(ptr)); }
+        inline static vfloat4 zero() { return vfloat4(_mm_setzero_ps()); }
+
+        // Every lane holding the bit pattern `bits`, e.g. to carry indices through select().
+        inline static vfloat4 fromBits(uint32_t bits) { return vfloat4(_mm_castsi128_ps(_mm_set1_epi32(int32_t(bits)))); }
+
+        inline void store(float* ptr) const { _mm_storeu_ps(ptr, m_value); }
+        inline void storeAligned(float* ptr) const { _mm_store_ps(ptr, m_value); }
+        inline void storeBits(uint32_t* ptr) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), _mm_castps_si128(m_value)); }
+
+        inline __m128 get() const { return m_value; }
+
+        template<int32_t index>
+        inline float get() const
+        {
+            static_assert(index < 4 && "Don't get over 4 in vfloat4!");
+            return _mm_cvtss_f32(_mm_shuffle_ps(m_value, m_value, _MM_SHUFFLE(index, index, index, index)));
+        }
+
+        inline float operator[](int32_t index) const
+        {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, m_value);
+            return lanes[index];
+        }
+
+        inline vfloat4 operator+(const vfloat4& v) const { return vfloat4(_mm_add_ps(m_value, v.m_value)); }
+        inline vfloat4 operator-(const vfloat4& v) const { return vfloat4(_mm_sub_ps(m_value, v.m_value)); }
+        inline vfloat4 operator*(const vfloat4& v) const { return vfloat4(_mm_mul_ps(m_value, v.m_value)); }
+        inline vfloat4 operator/(const vfloat4& v) const { return vfloat4(_mm_div_ps(m_value, v.m_value)); }
+
+        inline vfloat4 operator*(float v) const { return vfloat4(_mm_mul_ps(m_value, _mm_set1_ps(v))); }
+
+        inline vfloat4& operator+=(const vfloat4& v) { m_value = _mm_add_ps(m_value, v.m_value); return *this; }
+        inline vfloat4& operator-=(const vfloat4& v) { m_value = _mm_sub_ps(m_value, v.m_value); return *this; }
+        inline vfloat4& operator*=(const vfloat4& v) { m_value = _mm_mul_ps(m_value, v.m_value); return *this; }
+
+        inline vfloat4 operator-() const { return vfloat4(_mm_xor_ps(m_value, _mm_set1_ps(-0.0f))); }
+
+        inline vfloat4 operator<(const vfloat4& v) const { return vfloat4(_mm_cmplt_ps(m_value, v.m_value)); }
+        inline vfloat4 operator<=(const vfloat4& v) const { return vfloat4(_mm_cmple_ps(m_value, v.m_value)); }
+        inline vfloat4 operator>(const vfloat4& v) const { return vfloat4(_mm_cmpgt_ps(m_value, v.m_value)); }
+        inline vfloat4 operator>=(const vfloat4& v) const { return vfloat4(_mm_cmpge_ps(m_value, v.m_value)); }
+
+        inline vfloat4 operator&(const vfloat4& v) const { return vfloat4(_mm_and_ps(m_value, v.m_value)); }
+        inline vfloat4 operator|(const vfloat4& v) const { return vfloat4(_mm_or_ps(m_value, v.m_value)); }
+
+    private:
+        __m128 m_value;
+    };
+
+    inline vfloat4 operator*(float v, const vfloat4& vec) { return vec * v; }
+
+    inline vfloat4 min(const vfloat4& a, const vfloat4& b) { return vfloat4(_mm_min_ps(a.get(), b.get())); }
+    inline vfloat4 max(const vfloat4& a, const vfloat4& b) { return vfloat4(_mm_max_ps(a.get(), b.get())); }
+
+    inline vfloat4 abs(const vfloat4& v) { return vfloat4(_mm_andnot_ps(_mm_set1_ps(-0.0f), v.get())); }
+    inline vfloat4 sqrt(const vfloat4& v) { return vfloat4(_mm_sqrt_ps(v.get())); }
+
+    // a * b + c.
+    inline vfloat4 madd(const vfloat4& a, const vfloat4& b, const vfloat4& c) { return a * b + c; }
+
+    // a * b rounded on its own. GCC and Clang contract a product feeding an add into FMA
+    // when it is available, even through intrinsics, so kernels whose bits must not depend
+    // on the ISA build use these. MSVC never fuses intrinsics.
+    inline vfloat4 mulUnfused(const vfloat4& a, const vfloat4& b)
+    {
+        __m128 product = _mm_mul_ps(a.get(), b.get());
+#if defined(__GNUC__)
+        __asm__("" : "+x"(product));
+#endif
+        return vfloat4(product);
+    }
+
+    inline vfloat4 maddUnfused(const vfloat4& a, const vfloat4& b, const vfloat4& c) { return mulUnfused(a, b) + c; }
+
+    // Lanes of `a` where `mask` is set, otherwise lanes of `b`.
+    inline vfloat4 select(const vfloat4& mask, const vfloat4& a, const vfloat4& b)
+    {
+#if defined(__SSE4_1__) || defined(__AVX__)
+        return vfloat4(_mm_blendv_ps(b.get(), a.get(), mask.get()));
+#else
+        return vfloat4(_mm_or_ps(_mm_and_ps(mask.get(), a.get()), _mm_andnot_ps(mask.get(), b.get())));
+#endif
+    }
+
+    inline vfloat4 floor(const vfloat4& v)
+    {
+#if defined(__SSE4_1__) || defined(__AVX__)
+        return vfloat4(_mm_floor_ps(v.get()));
+#else
+        // Truncate, then step down the negative lanes that had a fraction.
+        const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(v.get()));
+        const __m128 fix = _mm_and_ps(_mm_cmpgt_ps(truncated, v.get()), _mm_set1_ps(1.0f));
+        return vfloat4(_mm_sub_ps(truncated, fix));
+#endif
+    }
+
+    // One bit per lane, lane 0 in bit 0.
+    inline int32_t movemask(const vfloat4& mask) { return _mm_movemask_ps(mask.get()); }
+
+    inline bool any(const vfloat4& mask) { return movemask(mask) != 0; }
+    inline bool all(const vfloat4& mask) { return movemask(mask) == 0xf; }
+
+    // Lanes in the given order, swizzle<2, 0, 1, 3>(v) is a single shufps (vpermilps with AVX).
+    template<int32_t i0, int32_t i1, int32_t i2, int32_t i3>
+    inline vfloat4 swizzle(const vfloat4& v)
+    {
+        static_assert(i0 >= 0 && i0 < 4 && i1 >= 0 && i1 < 4 && i2 >= 0 && i2 < 4 && i3 >= 0 && i3 < 4 && "Don't swizzle over 4 in vfloat4!");
+        return vfloat4(_mm_shuffle_ps(v.get(), v.get(), _MM_SHUFFLE(i3, i2, i1, i0)));
+    }
+
+    // Sine and cosine of every lane, about 2 ulp for |x| up to a few thousand radians.
+    // Never fused, the same bits on every ISA build.
+    inline void sincos(const vfloat4& x, vfloat4& outSin, vfloat4& outCos)
+    {
+        // Quadrant j = round(x / (pi / 2)), then x - j * pi / 2 in three parts.
+        const __m128i j = _mm_cvtps_epi32(_mm_mul_ps(x.get(), _mm_set1_ps(0.63661977236758134f)));
+        const vfloat4 jf(_mm_cvtepi32_ps(j));
+
+        vfloat4 y = x - mulUnfused(jf, vfloat4(1.5703125f));
+        y = y - mulUnfused(jf, vfloat4(4.837512969970703125e-4f));
+        y = y - mulUnfused(jf, vfloat4(7.54978995489188216e-8f));
+
+        const vfloat4 z = y * y;
+
+        vfloat4 s = maddUnfused(z, vfloat4(-1.9515295891e-4f), vfloat4(8.3321608736e-3f));
+        s = maddUnfused(s, z, vfloat4(-1.6666654611e-1f));
+        s = maddUnfused(s * z, y, y);
+
+        vfloat4 c = maddUnfused(z, vfloat4(2.443315711809948e-5f), vfloat4(-1.388731625493765e-3f));
+        c = maddUnfused(c, z, vfloat4(4.166664568298827e-2f));
+        c = maddUnfused(c * z, z, vfloat4(1.0f) - mulUnfused(vfloat4(0.5f), z));
+
+        // Odd quadrants swap sine and cosine, quadrants 2, 3 negate sine, 1, 2 negate cosine.
+        const vfloat4 swap(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(1)), _mm_set1_epi32(1))));
+        const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), 30));
+        const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+        outSin = vfloat4(_mm_xor_ps(select(swap, c, s).get(), sinSign));
+        outCos = vfloat4(_mm_xor_ps(select(swap, s, c).get(), cosSign));
+    }
+
+    // Scalar counterparts, so kernels can be templated on float or a lane type.
+    inline float min(float a, float b) { return a < b ? a : b; }
+    inline float max(float a, float b) { return a > b ? a : b; }
+    inline float abs(float v) { return std::fabs(v); }
+    inline float sqrt(float v) { return std::sqrt(v); }
+    inline float floor(float v) { return std::floor(v); }
+    inline float madd(float a, float b, float c) { return a * b + c; }
+    inline float select(bool mask, float a, float b) { return mask ? a : b; }
+}
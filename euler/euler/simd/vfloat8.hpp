@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <immintrin.h>
+
+#include "isa.hpp"
+#include "vfloat4.hpp"
+
+// Eight lane counterpart of vfloat4, only available when the compiler targets AVX
+// (/arch:AVX, /arch:AVX2, -mavx). Kernels templated on the lane type check
+// EULER_HAS_VFLOAT8 before instantiating the wide path.
+#if defined(__AVX__)
+#define EULER_HAS_VFLOAT8 1
+
+namespace euler
+{
+    class vfloat8
+    {
+    public:
+        static constexpr int32_t kWidth = 8;
+        static constexpr isa kPath = kCompiledIsa >= isa::avx2 ? isa::avx2 : isa::avx;
+
+        explicit vfloat8() = default;
+        explicit vfloat8(float v) : m_value(_mm256_set1_ps(v)) { }
+        explicit vfloat8(__m256 v) : m_value(v) { }
+
+        inline static vfloat8 load(const float* ptr) { return vfloat8(_mm256_loadu_ps(ptr)); }
+        inline static vfloat8 loadAligned(const float* ptr) { return vfloat8(_mm256_load_ps(ptr)); }
+        inline static vfloat8 zero() { return vfloat8(_mm256_setzero_ps()); }
+        inline static vfloat8 fromBits(uint32_t bits) { return vfloat8(_mm256_castsi256_ps(_mm256_set1_epi32(int32_t(bits)))); }
+
+        inline void store(float* ptr) const { _mm256_storeu_ps(ptr, m_value); }
+        inline void storeAligned(float* ptr) const { _mm256_store_ps(ptr, m_value); }
+        inline void storeBits(uint32_t* ptr) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), _mm256_castps_si256(m_value)); }
+
+        inline __m256 get() const { return m_value; }
+
+        inline float operator[](int32_t index) const
+        {
+            alignas(32) float lanes[8];
+            _mm256_store_ps(lanes, m_value);
+            return lanes[index];
+        }
+
+        inline vfloat8 operator+(const vfloat8& v) const { return vfloat8(_mm256_add_ps(m_value, v.m_value)); }
+        inline vfloat8 operator-(const vfloat8& v) const { return vfloat8(_mm256_sub_ps(m_value, v.m_value)); }
+        inline vfloat8 operator*(const vfloat8& v) const { return vfloat8(_mm256_mul_ps(m_value, v.m_value)); }
+        inline vfloat8 operator/(const vfloat8& v) const { return vfloat8(_mm256_div_ps(m_value, v.m_value)); }
+
+        inline vfloat8 operator*(float v) const { return vfloat8(_mm256_mul_ps(m_value, _mm256_set1_ps(v))); }
+
+        inline vfloat8& operator+=(const vfloat8& v) { m_value = _mm256_add_ps(m_value, v.m_value); return *this; }
+        inline vfloat8& operator-=(const vfloat8& v) { m_value = _mm256_sub_ps(m_value, v.m_value); return *this; }
+        inline vfloat8& operator*=(const vfloat8& v) { m_value = _mm256_mul_ps(m_value, v.m_value); return *this; }
+
+        inline vfloat8 operator-() const { return vfloat8(_mm256_xor_ps(m_value, _mm256_set1_ps(-0.0f))); }
+
+        inline vfloat8 operator<(const vfloat8& v) const { return vfloat8(_mm256_cmp_ps(m_value, v.m_value, _CMP_LT_OQ)); }
+        inline vfloat8 operator<=(const vfloat8& v) const { return vfloat8(_mm256_cmp_ps(m_value, v.m_value, _CMP_LE_OQ)); }
+        inline vfloat8 operator>(const vfloat8& v) const { return vfloat8(_mm256_cmp_ps(m_value, v.m_value, _CMP_GT_OQ)); }
+        inline vfloat8 operator>=(const vfloat8& v) const { return vfloat8(_mm256_cmp_ps(m_value, v.m_value, _CMP_GE_OQ)); }
+
+        inline vfloat8 operator&(const vfloat8& v) const { return vfloat8(_mm256_and_ps(m_value, v.m_value)); }
+        inline vfloat8 operator|(const vfloat8& v) const { return vfloat8(_mm256_or_ps(m_value, v.m_value)); }
+
+    private:
+        __m256 m_value;
+    };
+
+    inline vfloat8 operator*(float v, const vfloat8& vec) { return vec * v; }
+
+    inline vfloat8 min(const vfloat8& a, const vfloat8& b) { return vfloat8(_mm256_min_ps(a.get(), b.get())); }
+    inline vfloat8 max(const vfloat8& a, const vfloat8& b) { return vfloat8(_mm256_max_ps(a.get(), b.get())); }
+
+    inline vfloat8 abs(const vfloat8& v) { return vfloat8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), v.get())); }
+    inline vfloat8 sqrt(const vfloat8& v) { return vfloat8(_mm256_sqrt_ps(v.get())); }
+    inline vfloat8 floor(const vfloat8& v) { return vfloat8(_mm256_floor_ps(v.get())); }
+
+    inline vfloat8 madd(const vfloat8& a, const vfloat8& b, const vfloat8& c) { return a * b + c; }
+
+    inline vfloat8 select(const vfloat8& mask, const vfloat8& a, const vfloat8& b)
+    {
+        return vfloat8(_mm256_blendv_ps(b.get(), a.get(), mask.get()));
+    }
+
+    inline int32_t movemask(const vfloat8& mask) { return _mm256_movemask_ps(mask.get()); }
+
+    inline bool any(const vfloat8& mask) { return movemask(mask) != 0; }
+    inline bool all(const vfloat8& mask) { return movemask(mask) == 0xff; }
+
+    // Same swizzle applied to lanes 0..3 and to lanes 4..7, a single vpermilps.
+    template<int32_t i0, int32_t i1, int32_t i2, int32_t i3>
+    inline vfloat8 swizzle(const vfloat8& v)
+    {
+        static_assert(i0 >= 0 && i0 < 4 && i1 >= 0 && i1 < 4 && i2 >= 0 && i2 < 4 && i3 >= 0 && i3 < 4 && "Don't swizzle over 4 in vfloat8 halves!");
+        return vfloat8(_mm256_permute_ps(v.get(), _MM_SHUFFLE(i3, i2, i1, i0)));
+    }
+}
+#else
+#define EULER_HAS_VFLOAT8 0
+#endif
+
+namespace euler
+{
+    // Widest lane type of this translation unit.
+#if EULER_HAS_VFLOAT8
+    using vfloatn = vfloat8;
+#else
+    using vfloatn = vfloat4;
+#endif
+
+    namespace detail
+    {
+        // Dot product of two vectors held one component per lane type, V is vfloat4 or vfloat8.
+        template<typename V>
+        inline V dot3(const V& ax, const V& ay, const V& az, const V& bx, const V& by, const V& bz)
+        {
+            return madd(ax, bx, madd(ay, by, az * bz));
+        }
+
+        template<typename V>
+        inline V dot3(const V (&a)[3], const V (&b)[3]) { return dot3(a[0], a[1], a[2], b[0], b[1], b[2]); }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+
+#include "CppUnitTest.h"
+
+namespace bench
+{
+	// Best wall time of `repeat` runs in milliseconds.
+	template<typename Fn>
+	inline double measureMs(int repeat, Fn&& fn)
+	{
+		double best = 1e30;
+		for (int i = 0; i < repeat; i++)
+		{
+			const auto t0 = std::chrono::steady_clock::now();
+			fn();
+			const auto t1 = std::chrono::steady_clock::now();
+
+			best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+		}
+		return best;
+	}
+
+	inline void report(const char* format, ...)
+	{
+		char buffer[512];
+
+		va_list args;
+		va_start(args, format);
+		std::vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+
+		Microsoft::VisualStudio::CppUnitTestFramework::Logger::WriteMessage(buffer);
+	}
+}
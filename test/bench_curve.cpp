@@ -0,0 +1,97 @@
+#include <vector>
+
+#include "CppUnitTest.h"
+#include "bench.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace bench
+{
+	TEST_CLASS(curve_throughput)
+	{
+	public:
+		TEST_METHOD(curve_one_curve_many_parameters)
+		{
+			const size_t count = 1 << 20;
+
+			std::vector<vec3f> points;
+			for (int32_t i = 0; i < 64; i++)
+			{
+				points.push_back(vec3f(float(i), float(i % 7), float(i % 3)));
+			}
+			const std::span<const vec3f> view(points);
+			const uint32_t segments = curveSegmentCount<curveBasis::catmullRom>(points.size());
+
+			std::vector<float> u(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				u[i] = float(i) / float(count) * float(segments);
+			}
+
+			std::vector<vec3f> scalar(count), bulk(count);
+
+			const double scalarMs = measureMs(5, [&]()
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					scalar[i] = evaluateCurve<curveBasis::catmullRom>(view, u[i]);
+				}
+			});
+			const double bulkMs = measureMs(5, [&]()
+			{
+				evaluateCurve<curveBasis::catmullRom>(view, u, std::span<vec3f>(bulk));
+			});
+
+			report("catmullRom 1M parameters: scalar %.3f ms, bulk %.3f ms\n", scalarMs, bulkMs);
+			Assert::IsTrue(lengthSquare(scalar[count / 3] - bulk[count / 3]) < 1e-6f);
+		}
+
+		TEST_METHOD(curve_many_curves_one_parameter)
+		{
+			const size_t count = 1 << 20;
+
+			std::vector<vec3f> controls[4];
+			std::vector<float> comps[4][3];
+			for (int32_t k = 0; k < 4; k++)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					const vec3f p(float(i % 97) + float(k), float(k * k), float(i % 13));
+					controls[k].push_back(p);
+					comps[k][0].push_back(p.getX());
+					comps[k][1].push_back(p.getY());
+					comps[k][2].push_back(p.getZ());
+				}
+			}
+
+			const csoa3f soaControls[4] =
+			{
+				csoa3f(comps[0][0], comps[0][1], comps[0][2]),
+				csoa3f(comps[1][0], comps[1][1], comps[1][2]),
+				csoa3f(comps[2][0], comps[2][1], comps[2][2]),
+				csoa3f(comps[3][0], comps[3][1], comps[3][2]),
+			};
+
+			std::vector<vec3f> scalar(count);
+			std::vector<float> x(count), y(count), z(count);
+			const soa3f out(x, y, z);
+
+			const double scalarMs = measureMs(5, [&]()
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					scalar[i] = evaluateSegment<curveBasis::bezier>(controls[0][i], controls[1][i], controls[2][i], controls[3][i], 0.37f);
+				}
+			});
+			const double bulkMs = measureMs(5, [&]()
+			{
+				evaluateSegments<curveBasis::bezier>(soaControls, 0.37f, out);
+			});
+
+			report("bezier 1M curves: scalar %.3f ms, soa %.3f ms\n", scalarMs, bulkMs);
+			Assert::IsTrue(lengthSquare(scalar[count / 3] - out.get(count / 3)) < 1e-6f);
+		}
+	};
+}
@@ -0,0 +1,70 @@
+#include <string_view>
+#include <vector>
+
+#include "CppUnitTest.h"
+#include "bench.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+static_assert(!instrument::kEnabled, "Benchmarks measure the default, uninstrumented build.");
+
+// The disabled scope must leave no code and no argument evaluation behind.
+#define BENCH_STRINGIZE_IMPL(x) #x
+#define BENCH_STRINGIZE(x) BENCH_STRINGIZE_IMPL(x)
+static_assert(std::string_view(BENCH_STRINGIZE(EULER_KERNEL_SCOPE(name, path, elements, bytes))) == "((void)0)",
+	"A disabled kernel scope expands to an empty statement.");
+
+namespace bench
+{
+	static void normalizePlain(std::vector<vec3f>& vecs)
+	{
+		for (vec3f& v : vecs)
+		{
+			v = normalize(v) * 2.0f;
+		}
+	}
+
+	static void normalizeScoped(std::vector<vec3f>& vecs)
+	{
+		EULER_KERNEL_SCOPE("bench::normalizeScoped", isa::scalar, vecs.size(), vecs.size() * sizeof(vec3f) * 2);
+
+		for (vec3f& v : vecs)
+		{
+			v = normalize(v) * 2.0f;
+		}
+	}
+
+	TEST_CLASS(instrument_overhead)
+	{
+	public:
+		TEST_METHOD(disabled_scope_is_free)
+		{
+			std::vector<vec3f> plain(1 << 20, vec3f(1.0f, 2.0f, 3.0f));
+			std::vector<vec3f> scoped(plain);
+
+			double plainMs  = 0.0;
+			double scopedMs = 0.0;
+
+			// Reported only, the static_assert above is the check; timings on a loaded
+			// machine are too noisy to assert on. Interleave the two so frequency scaling
+			// hits both alike.
+			for (int round = 0; round < 3; round++)
+			{
+				plainMs  = measureMs(5, [&]() { normalizePlain(plain); });
+				scopedMs = measureMs(5, [&]() { normalizeScoped(scoped); });
+			}
+
+			report("normalize 1M vec3f: plain %.3f ms, disabled scope %.3f ms\n", plainMs, scopedMs);
+
+			Assert::IsTrue(plain == scoped);
+
+			// A disabled scope never registers its kernel.
+			for (const instrument::kernelStats& stats : instrument::takeSnapshot().kernels)
+			{
+				Assert::IsTrue(stats.name != "bench::normalizeScoped");
+			}
+		}
+	};
+}
@@ -0,0 +1,146 @@
+#include <vector>
+
+#include "CppUnitTest.h"
+#include "bench.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace bench
+{
+	TEST_CLASS(intersect_throughput)
+	{
+	public:
+		// Ray triangle tests per second, every ray against every triangle.
+		TEST_METHOD(intersect_triangle_mtests_per_s)
+		{
+			const size_t rayCount = 1 << 14;
+			const uint32_t triangleCount = 256;
+
+			std::vector<float> coordinates((triangleCount * 3 + rayCount * 2) * 3);
+			sampleUniform(coordinates, 1);
+			auto point = [&](size_t i) { return vec3f(coordinates[i * 3], coordinates[i * 3 + 1], coordinates[i * 3 + 2]); };
+
+			std::vector<vec3f> positions;
+			std::vector<uint32_t> indices;
+			for (uint32_t i = 0; i < triangleCount * 3; i++)
+			{
+				positions.push_back(point(i));
+				indices.push_back(i);
+			}
+			const triangleSet triangles(positions, indices);
+
+			std::vector<precomputedTriangle> scalarTriangles;
+			for (size_t i = 0; i < triangles.size(); i++)
+			{
+				scalarTriangles.push_back(triangles.get(i));
+			}
+
+			std::vector<ray> rays;
+			std::vector<float> origin[3], direction[3];
+			for (size_t i = 0; i < rayCount; i++)
+			{
+				const vec3f o = point(triangleCount * 3 + i * 2) * 4.0f - vec3f(1.5f);
+				const vec3f d = point(triangleCount * 3 + i * 2 + 1) - o;
+				rays.push_back(ray(o, d));
+				for (int32_t k = 0; k < 3; k++)
+				{
+					origin[k].push_back(o[k]);
+					direction[k].push_back(d[k]);
+				}
+			}
+			std::vector<float> tMin(rayCount, 0.0f), tMax(rayCount, FLT_MAX);
+			const rayStream stream { csoa3f(origin[0], origin[1], origin[2]), csoa3f(direction[0], direction[1], direction[2]), tMin, tMax };
+			std::vector<rayHit> hits(rayCount);
+
+			const double tests = double(rayCount) * double(triangleCount);
+			auto mtests = [&](double ms) { return tests / (ms * 1000.0); };
+
+			const double scalarMs = measureMs(3, [&]()
+			{
+				for (size_t i = 0; i < rayCount; i++)
+				{
+					rayHit hit;
+					for (uint32_t t = 0; t < triangleCount; t++)
+					{
+						if (intersect(rays[i], scalarTriangles[t], hit))
+						{
+							hit.primitive = t;
+						}
+					}
+					hits[i] = hit;
+				}
+			});
+
+			const double single4Ms = measureMs(3, [&]()
+			{
+				for (size_t i = 0; i < rayCount; i++)
+				{
+					rayHit hit;
+					intersect<vfloat4>(rays[i], triangles, hit);
+					hits[i] = hit;
+				}
+			});
+			const double packet4Ms = measureMs(3, [&]() { intersect<vfloat4>(stream, triangles, hits); });
+
+			report("ray/triangle Mtests/s: scalar %.1f, %s single ray %.1f, %s packet %.1f\n", mtests(scalarMs),
+				isaName(vfloat4::kPath), mtests(single4Ms), isaName(vfloat4::kPath), mtests(packet4Ms));
+
+#if EULER_HAS_VFLOAT8
+			const double single8Ms = measureMs(3, [&]()
+			{
+				for (size_t i = 0; i < rayCount; i++)
+				{
+					rayHit hit;
+					intersect<vfloat8>(rays[i], triangles, hit);
+					hits[i] = hit;
+				}
+			});
+			const double packet8Ms = measureMs(3, [&]() { intersect<vfloat8>(stream, triangles, hits); });
+			const double threadedMs = measureMs(3, [&]() { intersect<vfloat8>(stream, triangles, hits, 0); });
+
+			report("ray/triangle Mtests/s: %s single ray %.1f, %s packet %.1f, all threads %.1f\n",
+				isaName(vfloat8::kPath), mtests(single8Ms), isaName(vfloat8::kPath), mtests(packet8Ms), mtests(threadedMs));
+#endif
+		}
+
+		TEST_METHOD(intersect_sphere_plane_mtests_per_s)
+		{
+			const size_t rayCount = 1 << 22;
+
+			std::vector<float> origin[3], direction[3];
+			for (int32_t k = 0; k < 3; k++)
+			{
+				origin[k].resize(rayCount);
+				direction[k].resize(rayCount);
+				sampleUniform(origin[k], 10 + k);
+				sampleUniform(direction[k], 20 + k);
+			}
+			std::vector<float> tMin(rayCount, 0.0f), tMax(rayCount, FLT_MAX);
+			const rayStream stream { csoa3f(origin[0], origin[1], origin[2]), csoa3f(direction[0], direction[1], direction[2]), tMin, tMax };
+			std::vector<rayHit> hits(rayCount);
+
+			const vec3f center(0.5f), normal = normalize(vec3f(1.0f, 1.0f, 0.0f));
+			const double scalarMs = measureMs(3, [&]()
+			{
+				for (size_t i = 0; i < rayCount; i++)
+				{
+					rayHit hit;
+					if (intersectSphere(ray(stream.origin.get(i), stream.direction.get(i)), center, 0.3f, hit))
+					{
+						hit.primitive = 0;
+					}
+					hits[i] = hit;
+				}
+			});
+			const double sphere4Ms = measureMs(3, [&]() { intersectSphere<vfloat4>(stream, center, 0.3f, hits); });
+			const double sphereNMs = measureMs(3, [&]() { intersectSphere<vfloatn>(stream, center, 0.3f, hits); });
+			const double planeNMs = measureMs(3, [&]() { intersectPlane<vfloatn>(stream, normal, 0.5f, hits); });
+
+			const double m = double(rayCount) / 1000.0;
+			report("ray/sphere Mtests/s: scalar %.1f, %s %.1f, %s %.1f; ray/plane %s %.1f\n", m / scalarMs,
+				isaName(vfloat4::kPath), m / sphere4Ms, isaName(vfloatn::kPath), m / sphereNMs, isaName(vfloatn::kPath), m / planeNMs);
+		}
+	};
+}
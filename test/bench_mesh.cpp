@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+#include "CppUnitTest.h"
+#include "bench.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace bench
+{
+	TEST_CLASS(mesh_throughput)
+	{
+	public:
+		TEST_METHOD(mesh_triangles_per_ms)
+		{
+			for (uint32_t n : { 708u, 2237u })
+			{
+				// n x n quads of a height field, 2 n^2 triangles: 10^6 and 10^7.
+				std::vector<vec3f> positions;
+				std::vector<vec2f> uvs;
+				std::vector<uint32_t> indices;
+				for (uint32_t y = 0; y <= n; y++)
+				{
+					for (uint32_t x = 0; x <= n; x++)
+					{
+						positions.push_back(vec3f(float(x), float(y), std::sin(float(x) * 0.01f) * std::cos(float(y) * 0.02f) * 50.0f));
+						uvs.push_back(vec2f(float(x), float(y)) / float(n));
+					}
+				}
+				for (uint32_t y = 0; y < n; y++)
+				{
+					for (uint32_t x = 0; x < n; x++)
+					{
+						const uint32_t i = y * (n + 1) + x;
+						indices.insert(indices.end(), { i, i + 1, i + n + 2, i, i + n + 2, i + n + 1 });
+					}
+				}
+				const size_t triangles = indices.size() / 3;
+				std::vector<vec3f> normals(positions.size());
+				std::vector<vec4f> tangents(positions.size());
+
+				auto cornerAngle = [](const vec3f& a, const vec3f& b)
+				{
+					const float denominator = std::sqrt(lengthSquare(a) * lengthSquare(b));
+					return denominator > 0.0f ? std::acos(std::clamp(dot(a, b) / denominator, -1.0f, 1.0f)) : 0.0f;
+				};
+
+				// The per triangle loops this module replaces, one per weighting.
+				auto normalizeNormals = [&]()
+				{
+					for (vec3f& normal : normals)
+					{
+						normal = normalize(normal);
+					}
+				};
+
+				auto scalarAreaNormals = [&]()
+				{
+					std::fill(normals.begin(), normals.end(), vec3f(0.0f));
+					for (size_t t = 0; t < indices.size(); t += 3)
+					{
+						const vec3f p0 = positions[indices[t]];
+						const vec3f n = cross(positions[indices[t + 1]] - p0, positions[indices[t + 2]] - p0);
+						normals[indices[t]] += n;
+						normals[indices[t + 1]] += n;
+						normals[indices[t + 2]] += n;
+					}
+					normalizeNormals();
+				};
+
+				auto scalarAngleNormals = [&]()
+				{
+					std::fill(normals.begin(), normals.end(), vec3f(0.0f));
+					for (size_t t = 0; t < indices.size(); t += 3)
+					{
+						const vec3f p[3] = { positions[indices[t]], positions[indices[t + 1]], positions[indices[t + 2]] };
+						const vec3f n = cross(p[1] - p[0], p[2] - p[0]);
+						const vec3f unit = lengthSquare(n) > 0.0f ? normalize(n) : n;
+						for (int32_t k = 0; k < 3; k++)
+						{
+							normals[indices[t + k]] += unit * cornerAngle(p[(k + 1) % 3] - p[k], p[(k + 2) % 3] - p[k]);
+						}
+					}
+					normalizeNormals();
+				};
+
+				auto finishTangents = [&]()
+				{
+					for (size_t v = 0; v < positions.size(); v++)
+					{
+						const vec3f t(tangents[v].getX(), tangents[v].getY(), tangents[v].getZ());
+						const vec3f o = normalize(t - normals[v] * dot(normals[v], t));
+						tangents[v] = vec4f(o.getX(), o.getY(), o.getZ(), tangents[v].getW() >= 0.0f ? 1.0f : -1.0f);
+					}
+				};
+
+				auto scalarFaceTangents = [&]()
+				{
+					std::fill(tangents.begin(), tangents.end(), vec4f(0.0f));
+					for (size_t t = 0; t < indices.size(); t += 3)
+					{
+						const uint32_t i[3] = { indices[t], indices[t + 1], indices[t + 2] };
+						const vec2f t21 = uvs[i[1]] - uvs[i[0]], t31 = uvs[i[2]] - uvs[i[0]];
+						const vec3f s = normalize((positions[i[1]] - positions[i[0]]) * t31.getY() - (positions[i[2]] - positions[i[0]]) * t21.getY());
+						const vec4f term(s.getX(), s.getY(), s.getZ(), t21.getX() * t31.getY() - t21.getY() * t31.getX());
+						tangents[i[0]] += term;
+						tangents[i[1]] += term;
+						tangents[i[2]] += term;
+					}
+					finishTangents();
+				};
+
+				// MikkTSpace: per corner, in the tangent plane of the vertex normal.
+				auto scalarAngleTangents = [&]()
+				{
+					std::fill(tangents.begin(), tangents.end(), vec4f(0.0f));
+					for (size_t t = 0; t < indices.size(); t += 3)
+					{
+						const uint32_t i[3] = { indices[t], indices[t + 1], indices[t + 2] };
+						const vec2f t21 = uvs[i[1]] - uvs[i[0]], t31 = uvs[i[2]] - uvs[i[0]];
+						const float area = t21.getX() * t31.getY() - t21.getY() * t31.getX();
+						const vec3f s = normalize((positions[i[1]] - positions[i[0]]) * t31.getY() - (positions[i[2]] - positions[i[0]]) * t21.getY());
+						for (int32_t k = 0; k < 3; k++)
+						{
+							const vec3f& n = normals[i[k]];
+							auto project = [&](const vec3f& v) { return v - n * dot(n, v); };
+
+							const float angle = cornerAngle(project(positions[i[(k + 1) % 3]] - positions[i[k]]), project(positions[i[(k + 2) % 3]] - positions[i[k]]));
+							const vec3f tangent = normalize(project(s)) * angle;
+							tangents[i[k]] += vec4f(tangent.getX(), tangent.getY(), tangent.getZ(), area > 0.0f ? angle : -angle);
+						}
+					}
+					finishTangents();
+				};
+
+				auto compare = [&](const char* pass, const double scalarMs, const double oneMs, const double allMs)
+				{
+					const double count = double(triangles);
+					report("%zu triangles/ms (%s, %u threads): %s scalar %.0f, 1 thread %.0f (%.2fx), all threads %.0f (%.2fx)\n",
+						triangles, isaName(vfloatn::kPath), resolveThreadCount(0), pass, count / scalarMs, count / oneMs, scalarMs / oneMs,
+						count / allMs, scalarMs / allMs);
+				};
+
+				compare("area normals", measureMs(5, scalarAreaNormals),
+					measureMs(5, [&]() { computeVertexNormals<normalWeight::area>(positions, indices, normals, 1); }),
+					measureMs(5, [&]() { computeVertexNormals<normalWeight::area>(positions, indices, normals, 0); }));
+				compare("angle normals", measureMs(5, scalarAngleNormals),
+					measureMs(5, [&]() { computeVertexNormals<normalWeight::angle>(positions, indices, normals, 1); }),
+					measureMs(5, [&]() { computeVertexNormals<normalWeight::angle>(positions, indices, normals, 0); }));
+
+				// Tangents from the module's angle weighted normals.
+				computeVertexNormals(positions, indices, normals);
+				compare("face tangents", measureMs(5, scalarFaceTangents),
+					measureMs(5, [&]() { computeTangents<tangentWeight::face>(positions, normals, uvs, indices, tangents, 1); }),
+					measureMs(5, [&]() { computeTangents<tangentWeight::face>(positions, normals, uvs, indices, tangents, 0); }));
+				compare("angle tangents", measureMs(5, scalarAngleTangents),
+					measureMs(5, [&]() { computeTangents<tangentWeight::angle>(positions, normals, uvs, indices, tangents, 1); }),
+					measureMs(5, [&]() { computeTangents<tangentWeight::angle>(positions, normals, uvs, indices, tangents, 0); }));
+			}
+		}
+	};
+}
@@ -0,0 +1,62 @@
+#include <vector>
+
+#include "CppUnitTest.h"
+#include "bench.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+// Define to also run 10^8 particles, about 3 GB of streams.
+// #define EULER_BENCH_HUGE
+
+namespace bench
+{
+	TEST_CLASS(particle_throughput)
+	{
+	public:
+		TEST_METHOD(particle_particles_per_ms)
+		{
+			const vec3f gravity(0.0f, -9.8f, 0.0f);
+			const auto forces = combineForces(gravityForce { gravity }, dragForce { 0.1f });
+			const float dt = 1.0f / 60.0f;
+
+			std::vector<size_t> counts = { 1000000, 10000000 };
+#ifdef EULER_BENCH_HUGE
+			counts.push_back(100000000);
+#endif
+
+			for (size_t count : counts)
+			{
+				double scalarMs = 0.0;
+				{
+					// The per particle loop this engine replaces.
+					std::vector<vec3f> pos(count, vec3f(0.0f)), vel(count, vec3f(1.0f));
+					scalarMs = measureMs(3, [&]()
+					{
+						for (size_t i = 0; i < count; i++)
+						{
+							const vec3f acc = gravity - vel[i] * 0.1f;
+							vel[i] += acc * dt;
+							pos[i] += vel[i] * dt;
+						}
+					});
+				}
+
+				particleSystem particles;
+				particles.reserve(count);
+				for (size_t i = 0; i < count; i++)
+				{
+					particles.add(vec3f(0.0f), vec3f(1.0f), 10.0f);
+				}
+
+				const double singleMs = measureMs(3, [&]() { particles.step<integrator::semiImplicitEuler>(dt, forces, 1); });
+				const double threadedMs = measureMs(3, [&]() { particles.step<integrator::semiImplicitEuler>(dt, forces, 0); });
+				const double rk4Ms = measureMs(3, [&]() { particles.step<integrator::rk4>(dt, forces, 0); });
+
+				report("%zu particles/ms: scalar %.0f, engine %.0f, all threads %.0f, rk4 all threads %.0f\n", count,
+					double(count) / scalarMs, double(count) / singleMs, double(count) / threadedMs, double(count) / rk4Ms);
+			}
+		}
+	};
+}
@@ -0,0 +1,43 @@
+#include <random>
+#include <vector>
+
+#include "CppUnitTest.h"
+#include "bench.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace bench
+{
+	TEST_CLASS(sampling_throughput)
+	{
+	public:
+		TEST_METHOD(sampling_unit_sphere)
+		{
+			const size_t count = 1 << 22;
+			std::vector<vec3f> out(count);
+
+			// The usual rejection loop: scalar random cube points, normalized.
+			const double rejectionMs = measureMs(3, [&]()
+			{
+				std::mt19937 rng(1);
+				std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+				for (size_t i = 0; i < count; i++)
+				{
+					vec3f v;
+					do
+					{
+						v = vec3f(dist(rng), dist(rng), dist(rng));
+					} while (lengthSquare(v) > 1.0f || lengthSquare(v) < 1e-12f);
+					out[i] = normalize(v);
+				}
+			});
+
+			const double bulkMs = measureMs(3, [&]() { sampleUnitSphere(out, 1); });
+			const double threadedMs = measureMs(3, [&]() { sampleUnitSphere(out, 1, 0, 0); });
+
+			report("unit sphere 4M: rejection %.2f ms, bulk %.2f ms, all threads %.2f ms\n", rejectionMs, bulkMs, threadedMs);
+		}
+	};
+}
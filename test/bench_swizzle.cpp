@@ -0,0 +1,133 @@
+#include <cstdint>
+#include <cstring>
+
+#include "CppUnitTest.h"
+#include "bench.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+// Probes keep their own body so the machine code can be read back; vectorcall makes MSVC
+// pass and return the lanes in registers like the System V ABI does.
+#if defined(_MSC_VER)
+#define SWIZZLE_PROBE __declspec(noinline)
+#define SWIZZLE_REGCALL __vectorcall
+#else
+#define SWIZZLE_PROBE __attribute__((noinline))
+#define SWIZZLE_REGCALL
+#endif
+
+namespace bench
+{
+	// Codegen is only meaningful with the optimizer on and without stack instrumentation.
+#if (defined(__OPTIMIZE__) || (defined(_MSC_VER) && defined(NDEBUG))) && !defined(__SANITIZE_ADDRESS__)
+	constexpr bool kOptimized = true;
+#else
+	constexpr bool kOptimized = false;
+#endif
+
+	static SWIZZLE_PROBE __m128 SWIZZLE_REGCALL swizzleLanes4(__m128 v) { return swizzle<2, 0, 1, 3>(vfloat4(v)).get(); }
+
+#if EULER_HAS_VFLOAT8
+	static SWIZZLE_PROBE __m256 SWIZZLE_REGCALL swizzleLanes8(__m256 v) { return swizzle<2, 0, 1, 3>(vfloat8(v)).get(); }
+#endif
+
+	static SWIZZLE_PROBE vec4f swizzleNamed4(const vec4f& v) { return v.zxyw(); }
+	static SWIZZLE_PROBE vec4f swizzleByHand4(const vec4f& v) { return vec4f(v.getZ(), v.getX(), v.getY(), v.getW()); }
+
+	static SWIZZLE_PROBE vec3f swizzleNamed3(const vec4f& v) { return v.wzy(); }
+	static SWIZZLE_PROBE vec3f swizzleByHand3(const vec4f& v) { return vec3f(v.getW(), v.getZ(), v.getY()); }
+
+	// First instruction of a function, past an incremental link thunk and an endbr64.
+	template<typename Fn>
+	static const uint8_t* codeOf(Fn* fn)
+	{
+		const uint8_t* code = reinterpret_cast<const uint8_t*>(fn);
+		if (code[0] == 0xe9)
+		{
+			int32_t offset;
+			std::memcpy(&offset, code + 1, sizeof(offset));
+			code += 5 + offset;
+		}
+
+		const uint8_t endbr64[] = { 0xf3, 0x0f, 0x1e, 0xfa };
+		return std::memcmp(code, endbr64, sizeof(endbr64)) == 0 ? code + sizeof(endbr64) : code;
+	}
+
+	// True when the code is exactly one of `shuffles`, register 0 to register 0 with
+	// immediate `imm`, followed by ret: no moves, loads or stores around it.
+	template<size_t count>
+	static bool isSingleShuffle(const uint8_t* code, const uint8_t (&shuffles)[count][5], uint8_t imm)
+	{
+		for (const uint8_t (&shuffle)[5] : shuffles)
+		{
+			size_t length = 0;
+			while (length < 5 && shuffle[length] != 0)
+			{
+				length++;
+			}
+			if (std::memcmp(code, shuffle, length) == 0 && code[length] == imm && code[length + 1] == 0xc3)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Same bytes up to and including the first ret.
+	template<typename Fn>
+	static bool sameCode(Fn* a, Fn* b)
+	{
+		const uint8_t* x = codeOf(a);
+		const uint8_t* y = codeOf(b);
+		for (size_t i = 0; i < 256; i++)
+		{
+			if (x[i] != y[i])
+			{
+				return false;
+			}
+			if (x[i] == 0xc3)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	TEST_CLASS(swizzle_codegen)
+	{
+	public:
+		// Swizzles must compile to what writing the components out by hand gives, and the
+		// lane swizzles to one in-register shuffle.
+		TEST_METHOD(swizzle_single_shuffle)
+		{
+			if (!kOptimized)
+			{
+				Logger::WriteMessage("swizzle codegen is only checked in optimized, uninstrumented builds\n");
+				return;
+			}
+
+			const vfloat4 v(1.0f, 2.0f, 3.0f, 4.0f);
+			Assert::IsTrue(vfloat4(swizzleLanes4(v.get()))[0] == 3.0f);
+			Assert::IsTrue(swizzleNamed4(vec4f(1.0f, 2.0f, 3.0f, 4.0f)) == vec4f(3.0f, 1.0f, 2.0f, 4.0f));
+
+			// shufps, pshufd, vshufps, vpshufd and vpermilps on xmm0.
+			const uint8_t shuffles4[][5] =
+			{
+				{ 0x0f, 0xc6, 0xc0 }, { 0x66, 0x0f, 0x70, 0xc0 },
+				{ 0xc5, 0xf8, 0xc6, 0xc0 }, { 0xc5, 0xf9, 0x70, 0xc0 }, { 0xc4, 0xe3, 0x79, 0x04, 0xc0 },
+			};
+			Assert::IsTrue(isSingleShuffle(codeOf(&swizzleLanes4), shuffles4, _MM_SHUFFLE(3, 1, 0, 2)));
+
+#if EULER_HAS_VFLOAT8
+			// vshufps and vpermilps on ymm0.
+			const uint8_t shuffles8[][5] = { { 0xc5, 0xfc, 0xc6, 0xc0 }, { 0xc4, 0xe3, 0x7d, 0x04, 0xc0 } };
+			Assert::IsTrue(isSingleShuffle(codeOf(&swizzleLanes8), shuffles8, _MM_SHUFFLE(3, 1, 0, 2)));
+#endif
+
+			Assert::IsTrue(sameCode(&swizzleNamed4, &swizzleByHand4));
+			Assert::IsTrue(sameCode(&swizzleNamed3, &swizzleByHand3));
+		}
+	};
+}
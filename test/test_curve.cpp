@@ -0,0 +1,196 @@
+#include <vector>
+#include <cmath>
+#include <limits>
+
+#include "CppUnitTest.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace geometry
+{
+	static bool nearlyEqual(const vec3f& a, const vec3f& b, float eps = 1e-4f)
+	{
+		return lengthSquare(a - b) <= eps * eps;
+	}
+
+	static std::vector<vec3f> makePoints(size_t count)
+	{
+		std::vector<vec3f> points;
+		for (size_t i = 0; i < count; i++)
+		{
+			const float f = float(i);
+			points.push_back(vec3f(f, std::sin(f) * 3.0f, std::cos(f * 0.7f) * 2.0f));
+		}
+		return points;
+	}
+
+	template<curveBasis basis>
+	static void checkBulkMatchesScalar()
+	{
+		const std::vector<vec3f> points = makePoints(13);
+		const std::span<const vec3f> view(points);
+		const uint32_t segments = curveSegmentCount<basis>(points.size());
+
+		std::vector<float> u;
+		for (int32_t i = -3; i < 103; i++)
+		{
+			u.push_back(float(i) / 100.0f * float(segments));
+		}
+
+		std::vector<vec3f> out(u.size());
+		evaluateCurve<basis>(view, u, std::span<vec3f>(out));
+
+		for (size_t i = 0; i < u.size(); i++)
+		{
+			Assert::IsTrue(nearlyEqual(out[i], evaluateCurve<basis>(view, u[i])));
+		}
+	}
+
+	TEST_CLASS(curve)
+	{
+	public:
+		TEST_METHOD(curve_interpolation)
+		{
+			const vec3f p0(0.0f), p1(1.0f, 2.0f, 0.0f), p2(3.0f, 2.0f, 1.0f), p3(4.0f, 0.0f, 1.0f);
+
+			Assert::IsTrue(nearlyEqual(evaluateSegment<curveBasis::bezier>(p0, p1, p2, p3, 0.0f), p0));
+			Assert::IsTrue(nearlyEqual(evaluateSegment<curveBasis::bezier>(p0, p1, p2, p3, 1.0f), p3));
+			Assert::IsTrue(nearlyEqual(evaluateSegment<curveBasis::catmullRom>(p0, p1, p2, p3, 0.0f), p1));
+			Assert::IsTrue(nearlyEqual(evaluateSegment<curveBasis::catmullRom>(p0, p1, p2, p3, 1.0f), p2));
+			Assert::IsTrue(nearlyEqual(evaluateSegment<curveBasis::hermite>(p0, p1, p2, p3, 0.0f), p0));
+			Assert::IsTrue(nearlyEqual(evaluateSegment<curveBasis::hermite>(p0, p1, p2, p3, 1.0f), p2));
+			Assert::IsTrue(nearlyEqual(evaluateSegment<curveBasis::bspline>(p0, p1, p2, p3, 0.0f), (p0 + p1 * 4.0f + p2) / 6.0f));
+
+			const vec3f cubic[] = { p0, p1, p2, p3 };
+			Assert::IsTrue(nearlyEqual(bezier(std::span<const vec3f>(cubic), 0.3f), evaluateSegment<curveBasis::bezier>(p0, p1, p2, p3, 0.3f)));
+
+			// NaN parameters stay NaN on both paths instead of indexing out of range.
+			const float nan[] = { std::numeric_limits<float>::quiet_NaN() };
+			vec3f bulk[1];
+			evaluateCurve<curveBasis::catmullRom>(std::span<const vec3f>(cubic), nan, std::span<vec3f>(bulk));
+			const vec3f scalar = evaluateCurve<curveBasis::catmullRom>(std::span<const vec3f>(cubic), nan[0]);
+			Assert::IsTrue(std::isnan(scalar.getX()) && std::isnan(bulk[0].getX()));
+		}
+
+		TEST_METHOD(curve_bulk_parameters)
+		{
+			checkBulkMatchesScalar<curveBasis::bezier>();
+			checkBulkMatchesScalar<curveBasis::hermite>();
+			checkBulkMatchesScalar<curveBasis::catmullRom>();
+			checkBulkMatchesScalar<curveBasis::bspline>();
+
+			const vec4f points4[] = { vec4f(0.0f), vec4f(1.0f, 2.0f, 3.0f, 4.0f), vec4f(2.0f), vec4f(-1.0f, 0.0f, 1.0f, 5.0f) };
+			const float u[] = { 0.0f, 0.25f, 0.5f, 0.75f, 1.0f };
+			vec4f out4[5];
+			evaluateCurve<curveBasis::bezier>(std::span<const vec4f>(points4), u, std::span<vec4f>(out4));
+			for (int32_t i = 0; i < 5; i++)
+			{
+				const vec4f expected = evaluateSegment<curveBasis::bezier>(points4[0], points4[1], points4[2], points4[3], u[i]);
+				Assert::IsTrue(lengthSquare(out4[i] - expected) < 1e-8f);
+			}
+		}
+
+		TEST_METHOD(curve_bulk_segments)
+		{
+			const size_t count = 37;
+
+			std::vector<float> comps[4][3];
+			for (int32_t k = 0; k < 4; k++)
+			{
+				for (int32_t c = 0; c < 3; c++)
+				{
+					for (size_t i = 0; i < count; i++)
+					{
+						comps[k][c].push_back(std::sin(float(i * 7 + k * 3 + c)));
+					}
+				}
+			}
+
+			const csoa3f controls[4] =
+			{
+				csoa3f(comps[0][0], comps[0][1], comps[0][2]),
+				csoa3f(comps[1][0], comps[1][1], comps[1][2]),
+				csoa3f(comps[2][0], comps[2][1], comps[2][2]),
+				csoa3f(comps[3][0], comps[3][1], comps[3][2]),
+			};
+
+			std::vector<float> x(count), y(count), z(count), t(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				t[i] = float(i) / float(count - 1);
+			}
+
+			const soa3f out(x, y, z);
+
+			evaluateSegments<curveBasis::catmullRom>(controls, 0.4f, out);
+			for (size_t i = 0; i < count; i++)
+			{
+				const vec3f expected = evaluateSegment<curveBasis::catmullRom>(
+					controls[0].get(i), controls[1].get(i), controls[2].get(i), controls[3].get(i), 0.4f);
+				Assert::IsTrue(nearlyEqual(out.get(i), expected));
+			}
+
+			evaluateSegments<curveBasis::bspline>(controls, std::span<const float>(t), out);
+			for (size_t i = 0; i < count; i++)
+			{
+				const vec3f expected = evaluateSegment<curveBasis::bspline>(
+					controls[0].get(i), controls[1].get(i), controls[2].get(i), controls[3].get(i), t[i]);
+				Assert::IsTrue(nearlyEqual(out.get(i), expected));
+			}
+		}
+
+		TEST_METHOD(curve_arc_length)
+		{
+			// Collinear evenly spaced control points make a straight line at unit speed.
+			std::vector<vec3f> points;
+			for (int32_t i = 0; i < 10; i++)
+			{
+				points.push_back(vec3f(float(i), 0.0f, 0.0f));
+			}
+
+			arcLengthTable3f<curveBasis::catmullRom> table(points, 8);
+			Assert::IsTrue(table.getMeasuredSegmentCount() == 0);
+
+			Assert::AreEqual(table.parameterAt(1.5f), 1.5f, 1e-4f);
+			Assert::IsTrue(table.getMeasuredSegmentCount() == 2);
+
+			Assert::AreEqual(table.totalLength(), 7.0f, 1e-4f);
+			Assert::IsTrue(table.getMeasuredSegmentCount() == 7);
+
+			const float distances[] = { 0.0f, 2.25f, 6.5f, 100.0f };
+			float u[4];
+			table.parametersAt(distances, u);
+			Assert::AreEqual(u[0], 0.0f, 1e-4f);
+			Assert::AreEqual(u[1], 2.25f, 1e-4f);
+			Assert::AreEqual(u[2], 6.5f, 1e-4f);
+			Assert::AreEqual(u[3], 7.0f, 1e-4f);
+
+			// NaN distances map to the start of the curve.
+			const float nan = std::numeric_limits<float>::quiet_NaN();
+			const float nanDistances[] = { nan, 3.0f };
+			table.parametersAt(nanDistances, u);
+			Assert::IsTrue(table.parameterAt(nan) == 0.0f && u[0] == 0.0f);
+			Assert::AreEqual(u[1], 3.0f, 1e-4f);
+
+			// Stretching the tail only re-measures the segments it touches.
+			for (size_t i = 6; i < points.size(); i++)
+			{
+				points[i] = vec3f(6.0f + float(i - 6) * 2.0f, 0.0f, 0.0f);
+			}
+			table.setPoints(points, 3);
+			Assert::IsTrue(table.getMeasuredSegmentCount() == 3);
+			Assert::AreEqual(table.parameterAt(2.5f), 2.5f, 1e-4f);
+			Assert::IsTrue(table.getMeasuredSegmentCount() == 3);
+			Assert::IsTrue(table.totalLength() > 7.5f);
+
+			// Dropping the last two points removes segments 5 and 6 even when the change is reported past them.
+			table.totalLength();
+			table.setPoints(std::span<const vec3f>(points.data(), 8), 6);
+			Assert::IsTrue(table.getMeasuredSegmentCount() == 5);
+			Assert::AreEqual(table.totalLength(), arcLengthTable3f<curveBasis::catmullRom>(std::span<const vec3f>(points.data(), 8), 8).totalLength(), 1e-6f);
+			Assert::IsTrue(table.parameterAt(100.0f) <= 5.0f);
+		}
+	};
+}
@@ -0,0 +1,162 @@
+// Counters are only recorded when enabled, keep this translation unit free of other
+// euler kernels so the flag stays consistent for them.
+#define EULER_ENABLE_INSTRUMENTATION 1
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CppUnitTest.h"
+#include "../euler/euler/scalar/tvec3.hpp"
+#include "../euler/euler/core/instrument.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace core
+{
+	static void normalizeAll(std::vector<vec3f>& vecs)
+	{
+		EULER_KERNEL_SCOPE("test::normalizeAll", isa::scalar, vecs.size(), vecs.size() * sizeof(vec3f) * 2);
+
+		for (vec3f& v : vecs)
+		{
+			v = normalize(v);
+		}
+	}
+
+	static const instrument::kernelStats* findKernel(const instrument::snapshot& snap, const char* name)
+	{
+		for (const instrument::kernelStats& stats : snap.kernels)
+		{
+			if (stats.name == name)
+			{
+				return &stats;
+			}
+		}
+		return nullptr;
+	}
+
+	TEST_CLASS(kernel_counters)
+	{
+	public:
+		TEST_METHOD(counts_and_bytes)
+		{
+			Assert::IsTrue(instrument::kEnabled);
+			instrument::reset();
+
+			std::vector<vec3f> vecs(1000, vec3f(1.0f, 2.0f, 3.0f));
+			normalizeAll(vecs);
+			normalizeAll(vecs);
+
+			const instrument::snapshot snap = instrument::takeSnapshot();
+			const instrument::kernelStats* stats = findKernel(snap, "test::normalizeAll");
+
+			Assert::IsTrue(stats != nullptr);
+			Assert::IsTrue(stats->calls == 2);
+			Assert::IsTrue(stats->elements == 2000);
+			Assert::IsTrue(stats->bytes == 2000 * sizeof(vec3f) * 2);
+			Assert::IsTrue(stats->isaCalls[static_cast<uint32_t>(isa::scalar)] == 2);
+			Assert::IsTrue(stats->cycles > 0);
+			Assert::IsTrue(snap.events.size() == 2);
+			Assert::IsTrue(snap.events[0].start <= snap.events[1].start);
+		}
+
+		TEST_METHOD(threads_sum)
+		{
+			instrument::reset();
+
+			std::vector<std::thread> threads;
+			for (int t = 0; t < 4; t++)
+			{
+				threads.emplace_back([]()
+				{
+					std::vector<vec3f> vecs(100, vec3f(0.0f, 4.0f, 3.0f));
+					for (int i = 0; i < 10; i++)
+					{
+						normalizeAll(vecs);
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+
+			const instrument::snapshot snap = instrument::takeSnapshot();
+			const instrument::kernelStats* stats = findKernel(snap, "test::normalizeAll");
+
+			Assert::IsTrue(stats != nullptr);
+			Assert::IsTrue(stats->calls == 40);
+			Assert::IsTrue(stats->elements == 4000);
+			Assert::IsTrue(snap.events.size() == 40);
+		}
+
+		TEST_METHOD(threads_recycle_counters)
+		{
+			instrument::reset();
+
+			// Threads that never overlap share one counter block and one trace row.
+			for (int t = 0; t < 3; t++)
+			{
+				std::thread([]()
+				{
+					std::vector<vec3f> vecs(10, vec3f(1.0f));
+					normalizeAll(vecs);
+				}).join();
+			}
+
+			const instrument::snapshot snap = instrument::takeSnapshot();
+			const instrument::kernelStats* stats = findKernel(snap, "test::normalizeAll");
+
+			Assert::IsTrue(stats != nullptr);
+			Assert::IsTrue(stats->calls == 3);
+			Assert::IsTrue(stats->elements == 30);
+			Assert::IsTrue(snap.events.size() == 3);
+			Assert::IsTrue(snap.events[0].thread == snap.events[1].thread && snap.events[1].thread == snap.events[2].thread);
+		}
+
+		TEST_METHOD(chrome_trace)
+		{
+			instrument::reset();
+
+			std::vector<vec3f> vecs(10, vec3f(1.0f));
+			normalizeAll(vecs);
+
+			std::ostringstream out;
+			instrument::exportChromeTrace(instrument::takeSnapshot(), out);
+
+			const std::string json = out.str();
+			Assert::IsTrue(json.find("\"traceEvents\"") != std::string::npos);
+			Assert::IsTrue(json.find("\"name\":\"test::normalizeAll\"") != std::string::npos);
+			Assert::IsTrue(json.find("\"ph\":\"X\"") != std::string::npos);
+			Assert::IsTrue(json.find("\"isa\":\"scalar\"") != std::string::npos);
+		}
+
+		TEST_METHOD(chrome_trace_long_run)
+		{
+			// Two short calls 2.5 s into a trace must keep distinct, ordered timestamps.
+			instrument::snapshot snap;
+			snap.cyclesPerMicrosecond = 2.0;
+			snap.kernels.push_back({ "test::late" });
+			snap.events.push_back({ 0, 0, isa::scalar, 1000, 2, 1, 4 });
+			snap.events.push_back({ 0, 0, isa::scalar, 1000 + 5000003, 3, 1, 4 });
+			snap.events.push_back({ 0, 0, isa::scalar, 1000 + 5000014, 2, 1, 4 });
+
+			std::ostringstream out;
+			out << 0.5;
+			instrument::exportChromeTrace(snap, out);
+			out << 0.25;
+
+			const std::string json = out.str();
+			Assert::IsTrue(json.find("\"ts\":0.000,\"dur\":1.000") != std::string::npos);
+			Assert::IsTrue(json.find("\"ts\":2500001.500,\"dur\":1.500") != std::string::npos);
+			Assert::IsTrue(json.find("\"ts\":2500007.000,\"dur\":1.000") != std::string::npos);
+			Assert::IsTrue(json.find("e+") == std::string::npos);
+
+			// The stream formatting is left as the caller had it.
+			Assert::IsTrue(json.substr(0, 4) == "0.5{" && json.substr(json.size() - 4) == "0.25");
+		}
+	};
+}
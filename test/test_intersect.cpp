@@ -0,0 +1,267 @@
+#include <vector>
+#include <cmath>
+
+#include "CppUnitTest.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace geometry
+{
+	// Jittered n x n grid of quads around the z = 0 plane, two triangles per quad.
+	static void buildGrid(uint32_t n, std::vector<vec3f>& positions, std::vector<uint32_t>& indices)
+	{
+		positions.clear();
+		indices.clear();
+
+		uint32_t state = 12345u;
+		auto jitter = [&]()
+		{
+			state = state * 1664525u + 1013904223u;
+			return (float(state >> 8) / 16777216.0f - 0.5f) * 0.6f;
+		};
+
+		for (uint32_t y = 0; y <= n; y++)
+		{
+			for (uint32_t x = 0; x <= n; x++)
+			{
+				const bool border = x == 0 || y == 0 || x == n || y == n;
+				const float jx = border ? 0.0f : jitter();
+				const float jy = border ? 0.0f : jitter();
+				positions.push_back(vec3f(float(x) + jx, float(y) + jy, border ? 0.0f : jitter()) * 0.37f);
+			}
+		}
+
+		for (uint32_t y = 0; y < n; y++)
+		{
+			for (uint32_t x = 0; x < n; x++)
+			{
+				const uint32_t i = y * (n + 1) + x;
+				indices.insert(indices.end(), { i, i + 1, i + n + 2 });
+				indices.insert(indices.end(), { i, i + n + 2, i + n + 1 });
+			}
+		}
+	}
+
+	static void randomRays(size_t count, uint64_t seed, std::vector<float> (&origin)[3], std::vector<float> (&direction)[3])
+	{
+		std::vector<float> targets(count * 3);
+		std::vector<vec3f> offsets(count);
+		sampleUniform(targets, seed);
+		sampleUnitSphere(offsets, seed + 1);
+
+		for (int32_t k = 0; k < 3; k++)
+		{
+			origin[k].resize(count);
+			direction[k].resize(count);
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const vec3f target = vec3f(targets[i * 3], targets[i * 3 + 1], targets[i * 3 + 2]) * 2.0f - vec3f(0.5f);
+			const vec3f o = target + offsets[i] * 5.0f;
+			const vec3f d = target - o;
+			for (int32_t k = 0; k < 3; k++)
+			{
+				origin[k][i] = o[k];
+				direction[k][i] = d[k];
+			}
+		}
+	}
+
+	TEST_CLASS(intersection)
+	{
+	public:
+		TEST_METHOD(intersect_triangle_barycentrics)
+		{
+			const vec3f v0(0.0f, 0.0f, 1.0f), v1(2.0f, 0.0f, 1.0f), v2(0.0f, 2.0f, 1.0f);
+			const vec3f target = v0 * 0.5f + v1 * 0.3f + v2 * 0.2f;
+
+			for (float side : { 1.0f, -1.0f })
+			{
+				const ray r(target + vec3f(0.1f, -0.2f, 3.0f * side), vec3f(-0.1f, 0.2f, -3.0f * side));
+
+				rayHit hit;
+				Assert::IsTrue(intersect(r, v0, v1, v2, hit));
+				Assert::IsTrue(std::abs(hit.t - 1.0f) < 1e-5f);
+				Assert::IsTrue(std::abs(hit.u - 0.3f) < 1e-5f && std::abs(hit.v - 0.2f) < 1e-5f);
+			}
+
+			rayHit hit;
+			Assert::IsFalse(intersect(ray(vec3f(1.5f, 1.5f, 0.0f), vec3f(0.0f, 0.0f, 1.0f)), v0, v1, v2, hit));
+			Assert::IsFalse(intersect(ray(target + vec3f(0.0f, 0.0f, 1.0f), vec3f(1.0f, 0.0f, 0.0f)), v0, v1, v2, hit));
+			Assert::IsFalse(intersect(ray(target + vec3f(0.0f, 0.0f, 1.0f), vec3f(0.0f, 0.0f, 1.0f)), v0, v1, v2, hit));
+			Assert::IsFalse(intersect(ray(target + vec3f(0.0f, 0.0f, 1.0f), vec3f(0.0f, 0.0f, -1.0f), 0.0f, 0.5f), v0, v1, v2, hit));
+			Assert::IsFalse(hit.isHit());
+		}
+
+		TEST_METHOD(intersect_watertight_edges)
+		{
+			std::vector<vec3f> positions;
+			std::vector<uint32_t> indices;
+			buildGrid(24, positions, indices);
+			const triangleSet triangles(positions, indices);
+
+			// Aim at points on every interior edge, the ray must hit one of its two triangles.
+			const vec3f directions[] =
+			{
+				vec3f(0.0f, 0.0f, -1.0f), vec3f(0.3f, -0.7f, -1.0f), vec3f(-0.9f, 0.2f, 1.0f), vec3f(1e-3f, 2e-3f, -1.0f),
+			};
+
+			size_t rays = 0, misses = 0;
+			for (size_t tri = 0; tri < indices.size() / 3; tri++)
+			{
+				for (int32_t e = 0; e < 3; e++)
+				{
+					const vec3f a = positions[indices[tri * 3 + e]];
+					const vec3f b = positions[indices[tri * 3 + (e + 1) % 3]];
+					if (a.getZ() == 0.0f && b.getZ() == 0.0f)
+					{
+						continue;
+					}
+
+					for (float s : { 0.5f, 0.123456f, 0.987654f })
+					{
+						const vec3f target = a + (b - a) * s;
+						for (const vec3f& d : directions)
+						{
+							const ray r(target - d * 3.0f, d);
+
+							rayHit scalarHit, vectorHit;
+							const bool scalarFound = intersect<vfloat4>(r, triangles, scalarHit);
+							const bool wideFound = intersect<vfloatn>(r, triangles, vectorHit);
+
+							rays++;
+							misses += scalarFound ? 0 : 1;
+							misses += wideFound ? 0 : 1;
+						}
+					}
+				}
+			}
+
+			Assert::IsTrue(rays > 10000);
+			Assert::IsTrue(misses == 0);
+		}
+
+		TEST_METHOD(intersect_packet_matches_single)
+		{
+			std::vector<float> coordinates(300 * 3);
+			sampleUniform(coordinates, 7);
+
+			std::vector<vec3f> positions;
+			std::vector<uint32_t> indices;
+			for (size_t i = 0; i < 300; i++)
+			{
+				positions.push_back(vec3f(coordinates[i * 3], coordinates[i * 3 + 1], coordinates[i * 3 + 2]) * 2.0f - vec3f(0.5f));
+			}
+			for (uint32_t i = 0; i < 99 * 3; i++)
+			{
+				indices.push_back((i * 37u) % 300u);
+			}
+			const triangleSet triangles(positions, indices);
+
+			const size_t count = 1003;
+			std::vector<float> origin[3], direction[3];
+			randomRays(count, 11, origin, direction);
+			std::vector<float> tMin(count, 0.0f), tMax(count, FLT_MAX);
+			const rayStream stream { csoa3f(origin[0], origin[1], origin[2]), csoa3f(direction[0], direction[1], direction[2]), tMin, tMax };
+
+			std::vector<rayHit> hits4(count), hitsN(count), hitsThreaded(count);
+			euler::intersect<vfloat4>(stream, triangles, hits4);
+			euler::intersect<vfloatn>(stream, triangles, hitsN);
+			euler::intersect(stream, triangles, hitsThreaded, 0);
+
+			size_t hitCount = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				const ray r(vec3f(origin[0][i], origin[1][i], origin[2][i]), vec3f(direction[0][i], direction[1][i], direction[2][i]));
+
+				rayHit reference;
+				for (size_t tri = 0; tri < triangles.size(); tri++)
+				{
+					if (euler::intersect(r, triangles.get(tri), reference))
+					{
+						reference.primitive = uint32_t(tri);
+					}
+				}
+
+				for (const rayHit* hit : { &hits4[i], &hitsN[i], &hitsThreaded[i] })
+				{
+					Assert::IsTrue(hit->primitive == reference.primitive);
+					if (reference.isHit())
+					{
+						Assert::IsTrue(std::abs(hit->t - reference.t) <= 1e-4f * reference.t);
+						Assert::IsTrue(std::abs(hit->u - reference.u) < 1e-4f && std::abs(hit->v - reference.v) < 1e-4f);
+					}
+				}
+				hitCount += reference.isHit() ? 1 : 0;
+			}
+			Assert::IsTrue(hitCount > count / 10 && hitCount < count);
+		}
+
+		TEST_METHOD(intersect_sphere_and_plane)
+		{
+			const vec3f center(1.0f, 2.0f, 3.0f);
+
+			rayHit hit;
+			Assert::IsTrue(intersectSphere(ray(center - vec3f(0.0f, 0.0f, 10.0f), vec3f(0.0f, 0.0f, 2.0f)), center, 1.0f, hit));
+			Assert::IsTrue(std::abs(hit.t - 4.5f) < 1e-5f);
+
+			// From inside the far root is taken.
+			hit = rayHit();
+			Assert::IsTrue(intersectSphere(ray(center, vec3f(0.0f, 1.0f, 0.0f)), center, 1.0f, hit));
+			Assert::IsTrue(std::abs(hit.t - 1.0f) < 1e-5f);
+
+			// Small sphere far away, the naive discriminant loses it.
+			hit = rayHit();
+			Assert::IsTrue(intersectSphere(ray(vec3f(0.0f), vec3f(0.0f, 0.0f, 1.0f)), vec3f(0.0f, 0.0f, 1e5f), 0.01f, hit));
+			Assert::IsTrue(std::abs(hit.t - (1e5f - 0.01f)) < 0.02f);
+
+			hit = rayHit();
+			Assert::IsFalse(intersectSphere(ray(center + vec3f(1.01f, 0.0f, -5.0f), vec3f(0.0f, 0.0f, 1.0f)), center, 1.0f, hit));
+			Assert::IsFalse(intersectSphere(ray(center + vec3f(0.0f, 0.0f, 5.0f), vec3f(0.0f, 0.0f, 1.0f)), center, 1.0f, hit));
+
+			hit = rayHit();
+			Assert::IsTrue(intersectPlane(ray(vec3f(0.0f, 5.0f, 0.0f), vec3f(1.0f, -2.0f, 0.0f)), vec3f(0.0f, 1.0f, 0.0f), 1.0f, hit));
+			Assert::IsTrue(std::abs(hit.t - 2.0f) < 1e-6f);
+			Assert::IsFalse(intersectPlane(ray(vec3f(0.0f, 5.0f, 0.0f), vec3f(1.0f, 0.0f, 0.0f)), vec3f(0.0f, 1.0f, 0.0f), 1.0f, hit));
+
+			// A nearer sphere or plane after a triangle hit leaves no barycentrics behind.
+			for (int32_t surface = 0; surface < 2; surface++)
+			{
+				const ray r(vec3f(0.25f, 0.5f, -5.0f), vec3f(0.0f, 0.0f, 1.0f));
+				hit = rayHit();
+				Assert::IsTrue(intersect(r, vec3f(0.0f, 0.0f, 0.0f), vec3f(1.0f, 0.0f, 0.0f), vec3f(0.0f, 1.0f, 0.0f), hit));
+				Assert::IsTrue(hit.u > 0.0f && hit.v > 0.0f);
+
+				Assert::IsTrue(surface == 0 ? intersectSphere(r, vec3f(0.25f, 0.5f, -2.0f), 1.0f, hit) : intersectPlane(r, vec3f(0.0f, 0.0f, 1.0f), -1.0f, hit));
+				Assert::IsTrue(std::abs(hit.t - (surface == 0 ? 2.0f : 4.0f)) < 1e-5f && hit.u == 0.0f && hit.v == 0.0f);
+			}
+
+			// Stream form against the scalar one.
+			const size_t count = 257;
+			std::vector<float> origin[3], direction[3];
+			randomRays(count, 3, origin, direction);
+			std::vector<float> tMin(count, 0.0f), tMax(count, FLT_MAX);
+			const rayStream stream { csoa3f(origin[0], origin[1], origin[2]), csoa3f(direction[0], direction[1], direction[2]), tMin, tMax };
+
+			const vec3f sphereCenter(0.5f, 0.4f, 0.6f), planeNormal = normalize(vec3f(1.0f, 2.0f, 3.0f));
+			std::vector<rayHit> sphereHits(count), planeHits(count);
+			intersectSphere(stream, sphereCenter, 0.7f, sphereHits);
+			intersectPlane(stream, planeNormal, 0.5f, planeHits, 0);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const ray r(vec3f(origin[0][i], origin[1][i], origin[2][i]), vec3f(direction[0][i], direction[1][i], direction[2][i]));
+
+				rayHit sphere, plane;
+				const bool sphereFound = intersectSphere(r, sphereCenter, 0.7f, sphere);
+				const bool planeFound = intersectPlane(r, planeNormal, 0.5f, plane);
+				Assert::IsTrue(sphereFound == sphereHits[i].isHit() && planeFound == planeHits[i].isHit());
+				Assert::IsTrue(!sphereFound || std::abs(sphere.t - sphereHits[i].t) <= 1e-4f * sphere.t);
+				Assert::IsTrue(!planeFound || std::abs(plane.t - planeHits[i].t) <= 1e-4f * plane.t);
+			}
+		}
+	};
+}
@@ -0,0 +1,287 @@
+#include <vector>
+#include <cmath>
+
+#include "CppUnitTest.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace geometry
+{
+	// n x n quads over [0, n]^2, z from `height`, uv = (x, y) / n.
+	template<typename Height>
+	static void buildSurface(uint32_t n, Height&& height, std::vector<vec3f>& positions, std::vector<vec2f>& uvs, std::vector<uint32_t>& indices)
+	{
+		for (uint32_t y = 0; y <= n; y++)
+		{
+			for (uint32_t x = 0; x <= n; x++)
+			{
+				positions.push_back(vec3f(float(x), float(y), height(float(x), float(y))));
+				uvs.push_back(vec2f(float(x), float(y)) / float(n));
+			}
+		}
+
+		for (uint32_t y = 0; y < n; y++)
+		{
+			for (uint32_t x = 0; x < n; x++)
+			{
+				const uint32_t i = y * (n + 1) + x;
+				indices.insert(indices.end(), { i, i + 1, i + n + 2 });
+				indices.insert(indices.end(), { i, i + n + 2, i + n + 1 });
+			}
+		}
+	}
+
+	static float cornerAngle(const vec3f& a, const vec3f& b)
+	{
+		return std::acos(std::clamp(dot(a, b) / std::sqrt(lengthSquare(a) * lengthSquare(b)), -1.0f, 1.0f));
+	}
+
+	// Per triangle loops the mesh module replaces.
+	static std::vector<vec3f> referenceNormals(const std::vector<vec3f>& positions, const std::vector<uint32_t>& indices, bool angleWeighted)
+	{
+		std::vector<vec3f> normals(positions.size(), vec3f(0.0f));
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			const vec3f p[3] = { positions[indices[t]], positions[indices[t + 1]], positions[indices[t + 2]] };
+			const vec3f n = cross(p[1] - p[0], p[2] - p[0]);
+			for (int32_t k = 0; k < 3; k++)
+			{
+				const float weight = cornerAngle(p[(k + 1) % 3] - p[k], p[(k + 2) % 3] - p[k]);
+				normals[indices[t + k]] += angleWeighted ? normalize(n) * weight : n;
+			}
+		}
+
+		for (vec3f& n : normals)
+		{
+			n = lengthSquare(n) > 0.0f ? normalize(n) : n;
+		}
+		return normals;
+	}
+
+	static std::vector<vec4f> referenceTangents(const std::vector<vec3f>& positions, const std::vector<vec3f>& normals,
+		const std::vector<vec2f>& uvs, const std::vector<uint32_t>& indices, bool angleWeighted)
+	{
+		std::vector<vec4f> sums(positions.size(), vec4f(0.0f));
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			const uint32_t i[3] = { indices[t], indices[t + 1], indices[t + 2] };
+			const vec2f t21 = uvs[i[1]] - uvs[i[0]], t31 = uvs[i[2]] - uvs[i[0]];
+			const float area = t21.getX() * t31.getY() - t21.getY() * t31.getX();
+			const vec3f dPdu = normalize((positions[i[1]] - positions[i[0]]) * t31.getY() - (positions[i[2]] - positions[i[0]]) * t21.getY()) * (area > 0.0f ? 1.0f : -1.0f);
+
+			for (int32_t k = 0; k < 3; k++)
+			{
+				const vec3f& n = normals[i[k]];
+				auto project = [&](const vec3f& v) { return v - n * dot(n, v); };
+
+				const float angle = angleWeighted ? cornerAngle(project(positions[i[(k + 1) % 3]] - positions[i[k]]), project(positions[i[(k + 2) % 3]] - positions[i[k]])) : 1.0f;
+				const vec3f tangent = angleWeighted ? normalize(project(dPdu)) * angle : dPdu;
+				sums[i[k]] += vec4f(tangent.getX(), tangent.getY(), tangent.getZ(), area > 0.0f ? angle : -angle);
+			}
+		}
+
+		std::vector<vec4f> tangents;
+		for (size_t v = 0; v < sums.size(); v++)
+		{
+			const vec3f s = sums[v].xyz();
+			const vec3f t = normalize(s - normals[v] * dot(normals[v], s));
+			tangents.push_back(vec4f(t.getX(), t.getY(), t.getZ(), sums[v].getW() >= 0.0f ? 1.0f : -1.0f));
+		}
+		return tangents;
+	}
+
+	static bool nearVec(const vec3f& a, const vec3f& b, float tolerance)
+	{
+		return lengthSquare(a - b) <= tolerance * tolerance;
+	}
+
+	static vec3f xyz(const vec4f& v) { return v.xyz(); }
+
+	TEST_CLASS(mesh)
+	{
+	public:
+		TEST_METHOD(mesh_scattered_indices)
+		{
+			std::vector<vec3f> positions;
+			std::vector<vec2f> uvs;
+			std::vector<uint32_t> grid;
+			buildSurface(300, [](float x, float y) { return std::cos(x * 0.1f) * std::sin(y * 0.15f) * 4.0f; }, positions, uvs, grid);
+
+			// The second half of the triangles in scattered order, so their chunks touch
+			// vertices all over the mesh and go through the shared sums.
+			const size_t triangleCount = grid.size() / 3;
+			std::vector<uint32_t> indices;
+			for (size_t i = 0; i < triangleCount; i++)
+			{
+				const size_t t = i < triangleCount / 2 ? i : triangleCount / 2 + (i * 104729u) % (triangleCount - triangleCount / 2);
+				indices.insert(indices.end(), { grid[t * 3], grid[t * 3 + 1], grid[t * 3 + 2] });
+			}
+
+			const std::vector<vec3f> reference = referenceNormals(positions, indices, true);
+			std::vector<vec3f> normals(positions.size()), threaded(positions.size());
+			computeVertexNormals(positions, indices, normals);
+			computeVertexNormals(positions, indices, threaded, 3);
+
+			std::vector<vec4f> tangents(positions.size()), threadedTangents(positions.size());
+			computeTangents(positions, normals, uvs, indices, tangents);
+			computeTangents(positions, normals, uvs, indices, threadedTangents, 3);
+			const std::vector<vec4f> referenceFrames = referenceTangents(positions, normals, uvs, indices, true);
+
+			for (size_t v = 0; v < positions.size(); v++)
+			{
+				Assert::IsTrue(nearVec(normals[v], reference[v], 1e-4f) && threaded[v] == normals[v]);
+				Assert::IsTrue(nearVec(xyz(tangents[v]), xyz(referenceFrames[v]), 1e-4f) && tangents[v].getW() == referenceFrames[v].getW());
+				Assert::IsTrue(threadedTangents[v] == tangents[v]);
+			}
+
+			// In its own order the grid streams chunk by chunk on one thread, with the same sums.
+			computeVertexNormals(positions, grid, normals);
+			computeVertexNormals(positions, grid, threaded, 3);
+			computeTangents(positions, normals, uvs, grid, tangents);
+			computeTangents(positions, normals, uvs, grid, threadedTangents, 3);
+			for (size_t v = 0; v < positions.size(); v++)
+			{
+				Assert::IsTrue(threaded[v] == normals[v] && threadedTangents[v] == tangents[v]);
+			}
+		}
+
+		TEST_METHOD(mesh_flat_surface)
+		{
+			std::vector<vec3f> positions;
+			std::vector<vec2f> uvs;
+			std::vector<uint32_t> indices;
+			buildSurface(9, [](float, float) { return 0.0f; }, positions, uvs, indices);
+
+			std::vector<vec3f> angleNormals(positions.size()), areaNormals(positions.size());
+			computeVertexNormals<normalWeight::angle>(positions, indices, angleNormals);
+			computeVertexNormals<normalWeight::area>(positions, indices, areaNormals);
+
+			std::vector<vec4f> tangents(positions.size());
+			computeTangents(positions, angleNormals, uvs, indices, tangents);
+
+			// Mirror u, the tangent turns around and so does the handedness.
+			std::vector<vec2f> mirrored;
+			for (const vec2f& uv : uvs)
+			{
+				mirrored.push_back(vec2f(1.0f - uv.getX(), uv.getY()));
+			}
+			std::vector<vec4f> mirroredTangents(positions.size());
+			computeTangents(positions, angleNormals, mirrored, indices, mirroredTangents);
+
+			for (size_t v = 0; v < positions.size(); v++)
+			{
+				Assert::IsTrue(nearVec(angleNormals[v], vec3f(0.0f, 0.0f, 1.0f), 1e-6f));
+				Assert::IsTrue(nearVec(areaNormals[v], vec3f(0.0f, 0.0f, 1.0f), 1e-6f));
+
+				Assert::IsTrue(nearVec(xyz(tangents[v]), vec3f(1.0f, 0.0f, 0.0f), 1e-6f) && tangents[v].getW() == 1.0f);
+				Assert::IsTrue(nearVec(xyz(mirroredTangents[v]), vec3f(-1.0f, 0.0f, 0.0f), 1e-6f) && mirroredTangents[v].getW() == -1.0f);
+
+				// The bitangent follows increasing v either way.
+				Assert::IsTrue(nearVec(cross(angleNormals[v], xyz(mirroredTangents[v])) * mirroredTangents[v].getW(), vec3f(0.0f, 1.0f, 0.0f), 1e-6f));
+			}
+		}
+
+		TEST_METHOD(mesh_cube_angle_weighted)
+		{
+			std::vector<vec3f> positions;
+			for (uint32_t i = 0; i < 8; i++)
+			{
+				positions.push_back(vec3f((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f));
+			}
+			const std::vector<uint32_t> indices =
+			{
+				0, 2, 3, 0, 3, 1,  4, 5, 7, 4, 7, 6,  0, 1, 5, 0, 5, 4,
+				2, 6, 7, 2, 7, 3,  0, 4, 6, 0, 6, 2,  1, 3, 7, 1, 7, 5,
+			};
+
+			std::vector<vec3f> normals(positions.size());
+			computeVertexNormals<normalWeight::angle>(positions, indices, normals);
+
+			// Every corner sees 90 degrees of each of its three faces, whatever the diagonals.
+			for (size_t v = 0; v < positions.size(); v++)
+			{
+				Assert::IsTrue(nearVec(normals[v], normalize(positions[v]), 2e-4f));
+			}
+		}
+
+		TEST_METHOD(mesh_matches_reference)
+		{
+			std::vector<vec3f> positions;
+			std::vector<vec2f> uvs;
+			std::vector<uint32_t> indices;
+			buildSurface(80, [](float x, float y) { return std::sin(x * 0.3f) * std::cos(y * 0.2f) * 3.0f; }, positions, uvs, indices);
+
+			// Unused vertex and a triangle with degenerate uvs.
+			positions.push_back(vec3f(100.0f));
+			uvs.push_back(vec2f(0.5f));
+			const uint32_t flat = uint32_t(positions.size());
+			positions.insert(positions.end(), { vec3f(0.0f, 0.0f, 10.0f), vec3f(1.0f, 0.0f, 10.0f), vec3f(0.0f, 1.0f, 10.0f) });
+			uvs.insert(uvs.end(), { vec2f(0.25f), vec2f(0.25f), vec2f(0.25f) });
+			indices.insert(indices.end(), { flat, flat + 1, flat + 2 });
+
+			for (bool angleWeighted : { true, false })
+			{
+				const std::vector<vec3f> reference = referenceNormals(positions, indices, angleWeighted);
+
+				std::vector<vec3f> narrow(positions.size()), wide(positions.size()), threaded(positions.size());
+				if (angleWeighted)
+				{
+					computeVertexNormals<normalWeight::angle, vfloat4>(positions, indices, narrow);
+					computeVertexNormals<normalWeight::angle>(positions, indices, wide);
+					computeVertexNormals<normalWeight::angle>(positions, indices, threaded, 4);
+				}
+				else
+				{
+					computeVertexNormals<normalWeight::area, vfloat4>(positions, indices, narrow);
+					computeVertexNormals<normalWeight::area>(positions, indices, wide);
+					computeVertexNormals<normalWeight::area>(positions, indices, threaded, 4);
+				}
+
+				for (size_t v = 0; v < positions.size(); v++)
+				{
+					Assert::IsTrue(nearVec(narrow[v], reference[v], 1e-4f) && nearVec(wide[v], reference[v], 1e-4f));
+					Assert::IsTrue(threaded[v] == wide[v]);
+				}
+				Assert::IsTrue(narrow[flat - 1] == vec3f(0.0f));
+			}
+
+			std::vector<vec3f> normals(positions.size());
+			computeVertexNormals(positions, indices, normals);
+
+			for (bool angleWeighted : { true, false })
+			{
+				const std::vector<vec4f> reference = referenceTangents(positions, normals, uvs, indices, angleWeighted);
+
+				std::vector<vec4f> narrow(positions.size()), wide(positions.size()), threaded(positions.size());
+				if (angleWeighted)
+				{
+					computeTangents<tangentWeight::angle, vfloat4>(positions, normals, uvs, indices, narrow);
+					computeTangents<tangentWeight::angle>(positions, normals, uvs, indices, wide);
+					computeTangents<tangentWeight::angle>(positions, normals, uvs, indices, threaded, 4);
+				}
+				else
+				{
+					computeTangents<tangentWeight::face, vfloat4>(positions, normals, uvs, indices, narrow);
+					computeTangents<tangentWeight::face>(positions, normals, uvs, indices, wide);
+					computeTangents<tangentWeight::face>(positions, normals, uvs, indices, threaded, 4);
+				}
+
+				for (size_t v = 0; v < flat - 1; v++)
+				{
+					Assert::IsTrue(nearVec(xyz(narrow[v]), xyz(reference[v]), 1e-4f) && narrow[v].getW() == reference[v].getW());
+					Assert::IsTrue(nearVec(xyz(wide[v]), xyz(reference[v]), 1e-4f) && wide[v].getW() == reference[v].getW());
+					Assert::IsTrue(threaded[v] == wide[v]);
+				}
+
+				// Degenerate uvs still give a unit tangent in the tangent plane.
+				for (size_t v = flat; v < positions.size(); v++)
+				{
+					Assert::IsTrue(std::abs(lengthSquare(xyz(wide[v])) - 1.0f) < 1e-5f);
+					Assert::IsTrue(std::abs(dot(xyz(wide[v]), normals[v])) < 1e-5f);
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,187 @@
+#include <cstring>
+#include <vector>
+
+#include "CppUnitTest.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace physics
+{
+	// a = -p, a unit harmonic oscillator per axis.
+	struct springForce
+	{
+		inline void operator()(const vfloat4 (&p)[3], const vfloat4 (&)[3], vfloat4 (&a)[3]) const
+		{
+			a[0] -= p[0];
+			a[1] -= p[1];
+			a[2] -= p[2];
+		}
+	};
+
+	template<integrator method>
+	static float oscillatorError()
+	{
+		particleSystem particles;
+		particles.add(vec3f(1.0f, 0.0f, 0.0f), vec3f(0.0f, 1.0f, 0.0f), 1.0f);
+
+		// One full period, x = cos t and y = sin t come back to (1, 0).
+		const int32_t steps = 200;
+		const float dt = 6.28318530717958648f / float(steps);
+		for (int32_t i = 0; i < steps; i++)
+		{
+			particles.step<method>(dt, springForce());
+		}
+		return std::sqrt(lengthSquare(particles.positions().get(0) - vec3f(1.0f, 0.0f, 0.0f)));
+	}
+
+	TEST_CLASS(particle)
+	{
+	public:
+		TEST_METHOD(particle_constant_acceleration)
+		{
+			const gravityForce gravity { vec3f(0.0f, -9.8f, 0.0f) };
+			const vec3f p0(1.0f, 2.0f, 3.0f), v0(4.0f, 5.0f, 0.0f);
+			const float dt = 1.0f / 64.0f;
+			const int32_t steps = 64;
+
+			particleSystem rk4, verlet;
+			rk4.add(p0, v0, 10.0f);
+			verlet.add(p0, v0, 10.0f);
+
+			for (int32_t i = 0; i < steps; i++)
+			{
+				rk4.step<integrator::rk4>(dt, gravity);
+				verlet.step<integrator::velocityVerlet>(dt, gravity);
+			}
+
+			// Both are exact for constant acceleration.
+			const vec3f expected = p0 + v0 + gravity.gravity * 0.5f;
+			Assert::IsTrue(lengthSquare(rk4.positions().get(0) - expected) < 1e-8f);
+			Assert::IsTrue(lengthSquare(verlet.positions().get(0) - expected) < 1e-8f);
+			Assert::IsTrue(lengthSquare(rk4.velocities().get(0) - (v0 + gravity.gravity)) < 1e-8f);
+			Assert::AreEqual(rk4.life()[0], 9.0f, 1e-5f);
+		}
+
+		TEST_METHOD(particle_verlet_first_step)
+		{
+			const gravityForce gravity { vec3f(0.0f, -10.0f, 0.0f) };
+
+			particleSystem particles;
+			particles.add(vec3f(0.0f), vec3f(0.0f), 10.0f);
+			particles.step<integrator::velocityVerlet>(0.1f, gravity);
+			Assert::AreEqual(particles.velocities().get(0).getY(), -1.0f, 1e-6f);
+			Assert::AreEqual(particles.positions().get(0).getY(), -0.05f, 1e-6f);
+
+			// Particles added later, and survivors of a compaction, get their first step right too.
+			particles.add(vec3f(1.0f), vec3f(0.0f), 0.05f);
+			particles.add(vec3f(2.0f), vec3f(0.0f), 10.0f);
+			particles.step<integrator::velocityVerlet>(0.1f, gravity);
+			Assert::IsTrue(particles.compact() == 1);
+			particles.add(vec3f(3.0f), vec3f(0.0f), 10.0f);
+			particles.step<integrator::velocityVerlet>(0.1f, gravity);
+
+			Assert::AreEqual(particles.velocities().get(0).getY(), -3.0f, 1e-5f);
+			Assert::AreEqual(particles.velocities().get(1).getY(), -2.0f, 1e-5f);
+			Assert::AreEqual(particles.velocities().get(2).getY(), -1.0f, 1e-5f);
+			Assert::AreEqual(particles.positions().get(2).getY(), 2.95f, 1e-5f);
+
+			// Raw streams are primed by hand.
+			std::vector<float> c[9] = { { 0.0f }, { 0.0f }, { 0.0f }, { 0.0f }, { 0.0f }, { 0.0f }, { 0.0f }, { 0.0f }, { 0.0f } };
+			const particleStreams streams { soa3f(c[0], c[1], c[2]), soa3f(c[3], c[4], c[5]), soa3f(c[6], c[7], c[8]), std::span<float>() };
+			primeAcceleration(streams, gravity);
+			integrate<integrator::velocityVerlet>(streams, 0.1f, gravity);
+			Assert::AreEqual(streams.velocity.get(0).getY(), -1.0f, 1e-6f);
+			Assert::AreEqual(streams.position.get(0).getY(), -0.05f, 1e-6f);
+		}
+
+		TEST_METHOD(particle_integrator_order)
+		{
+			const float explicitError = oscillatorError<integrator::explicitEuler>();
+			const float semiImplicitError = oscillatorError<integrator::semiImplicitEuler>();
+			const float verletError = oscillatorError<integrator::velocityVerlet>();
+			const float rk4Error = oscillatorError<integrator::rk4>();
+
+			Assert::IsTrue(rk4Error < 1e-5f);
+			Assert::IsTrue(verletError < 1e-3f);
+			Assert::IsTrue(semiImplicitError < 0.1f);
+			Assert::IsTrue(explicitError > semiImplicitError);
+		}
+
+		TEST_METHOD(particle_matches_scalar)
+		{
+			const auto forces = combineForces(gravityForce { vec3f(0.0f, -9.8f, 0.0f) }, dragForce { 0.5f });
+			const float dt = 0.01f;
+			const size_t count = 1003;
+
+			particleSystem particles;
+			std::vector<vec3f> pos, vel;
+			for (size_t i = 0; i < count; i++)
+			{
+				const float f = float(i);
+				pos.push_back(vec3f(f, std::sin(f), 0.0f));
+				vel.push_back(vec3f(std::cos(f), 1.0f, f * 0.01f));
+				particles.add(pos.back(), vel.back(), 1.0f);
+			}
+
+			for (int32_t s = 0; s < 10; s++)
+			{
+				particles.step<integrator::semiImplicitEuler>(dt, forces, 3);
+				for (size_t i = 0; i < count; i++)
+				{
+					vel[i] += (vec3f(0.0f, -9.8f, 0.0f) - vel[i] * 0.5f) * dt;
+					pos[i] += vel[i] * dt;
+				}
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				Assert::IsTrue(lengthSquare(particles.positions().get(i) - pos[i]) < 1e-8f);
+				Assert::IsTrue(lengthSquare(particles.velocities().get(i) - vel[i]) < 1e-8f);
+			}
+		}
+
+		TEST_METHOD(particle_threads_reproducible)
+		{
+			const attractorForce attractor { vec3f(0.0f), 2.0f };
+			const size_t count = 70001;
+
+			particleSystem a, b;
+			for (size_t i = 0; i < count; i++)
+			{
+				const vec3f p(std::sin(float(i)), std::cos(float(i) * 0.3f), float(i % 17));
+				a.add(p, vec3f(0.0f), 1.0f);
+				b.add(p, vec3f(0.0f), 1.0f);
+			}
+
+			a.step<integrator::rk4>(0.01f, attractor, 1);
+			b.step<integrator::rk4>(0.01f, attractor, 4);
+
+			Assert::IsTrue(std::memcmp(a.positions().x().data(), b.positions().x().data(), count * sizeof(float)) == 0);
+			Assert::IsTrue(std::memcmp(a.velocities().z().data(), b.velocities().z().data(), count * sizeof(float)) == 0);
+		}
+
+		TEST_METHOD(particle_compaction)
+		{
+			particleSystem particles;
+			for (int32_t i = 0; i < 23; i++)
+			{
+				// Every third particle outlives the step.
+				particles.add(vec3f(float(i)), vec3f(0.0f), i % 3 == 0 ? 2.0f : 0.5f);
+			}
+
+			particles.step<integrator::explicitEuler>(1.0f, gravityForce { vec3f(0.0f) });
+			Assert::IsTrue(particles.compact() == 15);
+			Assert::IsTrue(particles.size() == 8);
+
+			for (size_t i = 0; i < particles.size(); i++)
+			{
+				Assert::IsTrue(particles.positions().get(i) == vec3f(float(i * 3)));
+				Assert::AreEqual(particles.life()[i], 1.0f, 1e-6f);
+			}
+
+			Assert::IsTrue(particles.compact() == 0);
+		}
+	};
+}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "CppUnitTest.h"
+#include "../euler/euler/euler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace euler;
+
+namespace sampling
+{
+	template<typename V>
+	static bool bitwiseEqual(const std::vector<V>& a, const std::vector<V>& b)
+	{
+		return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(V)) == 0;
+	}
+
+	TEST_CLASS(random)
+	{
+	public:
+		TEST_METHOD(philox_known_answers)
+		{
+			// Known answer vectors of the Random123 reference implementation.
+			Assert::IsTrue(philox4x32(vec4u(0u), vec2u(0u)) == vec4u(0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u));
+			Assert::IsTrue(philox4x32(vec4u(0xffffffffu), vec2u(0xffffffffu)) == vec4u(0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu));
+			Assert::IsTrue(philox4x32(vec4u(0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u), vec2u(0xa4093822u, 0x299f31d0u)) ==
+				vec4u(0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u));
+		}
+
+		TEST_METHOD(philox_lanes_match_scalar)
+		{
+			const uint64_t first = 0xfffffffeull;
+			const vec2u key = philoxKey(0x1234567890abcdefull);
+
+			__m128i words[4];
+			philoxCounters(first, 7, words);
+			philox4x32(words, key);
+
+			alignas(16) uint32_t lanes[4][4];
+			for (int32_t w = 0; w < 4; w++)
+			{
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes[w]), words[w]);
+			}
+
+			for (uint32_t l = 0; l < 4; l++)
+			{
+				const vec4u expected = philox4x32(philoxCounter(first + l, 7), key);
+				Assert::IsTrue(vec4u(lanes[0][l], lanes[1][l], lanes[2][l], lanes[3][l]) == expected);
+			}
+		}
+
+		TEST_METHOD(sincos_accuracy)
+		{
+			for (int32_t i = -4000; i <= 4000; i += 4)
+			{
+				const vfloat4 x(float(i) * 0.0031f, float(i + 1) * 0.0031f, float(i + 2) * 0.0031f, float(i + 3) * 0.0031f);
+
+				vfloat4 s, c;
+				sincos(x, s, c);
+				for (int32_t l = 0; l < 4; l++)
+				{
+					Assert::AreEqual(s[l], std::sin(x[l]), 2e-7f);
+					Assert::AreEqual(c[l], std::cos(x[l]), 2e-7f);
+				}
+			}
+		}
+	};
+
+	// FNV-1a over the bits of every sample.
+	template<typename V>
+	static uint32_t hashBits(const std::vector<V>& samples)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(samples.data());
+
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < samples.size() * sizeof(V); i++)
+		{
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+		return hash;
+	}
+
+	TEST_CLASS(sampler)
+	{
+	public:
+		TEST_METHOD(sampler_reproducible)
+		{
+			const size_t count = 100003;
+			const uint64_t seed = 42;
+
+			std::vector<vec3f> whole(count);
+			sampleUnitSphere(whole, seed);
+
+			// Odd sized pieces shift the four lane groups against the indices.
+			std::vector<vec3f> pieces(count);
+			for (size_t begin = 0; begin < count; begin += 4099)
+			{
+				const size_t n = std::min<size_t>(4099, count - begin);
+				sampleUnitSphere(std::span<vec3f>(pieces).subspan(begin, n), seed, begin);
+			}
+
+			std::vector<vec3f> threaded(count);
+			sampleUnitSphere(threaded, seed, 0, 3);
+
+			Assert::IsTrue(bitwiseEqual(whole, pieces));
+			Assert::IsTrue(bitwiseEqual(whole, threaded));
+
+			std::vector<vec3f> other(count);
+			sampleUnitSphere(other, seed + 1);
+			Assert::IsFalse(bitwiseEqual(whole, other));
+		}
+
+		TEST_METHOD(sampler_same_bits_every_isa)
+		{
+			// Hashes of the SSE2 build; every ISA and compiler must give the same bits.
+			std::vector<vec3f> sphere(4099), hemisphere(4099);
+			std::vector<vec2f> disk(4099);
+			sampleUnitSphere(sphere, 42);
+			sampleCosineHemisphere(hemisphere, 42);
+			sampleUniformDisk(disk, 42);
+
+			Assert::IsTrue(hashBits(sphere) == 0x611ca13eu);
+			Assert::IsTrue(hashBits(hemisphere) == 0x94e9a3b1u);
+			Assert::IsTrue(hashBits(disk) == 0x3fc408a1u);
+		}
+
+		TEST_METHOD(sampler_distributions)
+		{
+			const size_t count = 1 << 16;
+
+			std::vector<vec3f> sphere(count), hemisphere(count);
+			std::vector<vec2f> disk(count);
+			sampleUnitSphere(sphere, 7);
+			sampleCosineHemisphere(hemisphere, 7);
+			sampleUniformDisk(disk, 7);
+
+			vec3f sphereMean(0.0f);
+			float hemisphereMeanZ = 0.0f;
+			float diskMeanRadiusSquare = 0.0f;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				Assert::AreEqual(lengthSquare(sphere[i]), 1.0f, 1e-5f);
+				Assert::AreEqual(lengthSquare(hemisphere[i]), 1.0f, 1e-5f);
+				Assert::IsTrue(hemisphere[i].getZ() >= 0.0f);
+				Assert::IsTrue(lengthSquare(disk[i]) <= 1.0f + 1e-6f);
+
+				sphereMean += sphere[i];
+				hemisphereMeanZ += hemisphere[i].getZ();
+				diskMeanRadiusSquare += lengthSquare(disk[i]);
+			}
+
+			sphereMean /= float(count);
+			Assert::IsTrue(lengthSquare(sphereMean) < 1e-4f);
+
+			// E[cos theta] = 2 / 3 under cosine weighting, E[r^2] = 1 / 2 on the disk.
+			Assert::AreEqual(hemisphereMeanZ / float(count), 2.0f / 3.0f, 1e-2f);
+			Assert::AreEqual(diskMeanRadiusSquare / float(count), 0.5f, 1e-2f);
+		}
+
+		TEST_METHOD(sampler_low_discrepancy)
+		{
+			std::vector<vec2f> sobol(8);
+			sampleSobol2D(sobol);
+			Assert::IsTrue(sobol[0] == vec2f(0.0f, 0.0f));
+			Assert::IsTrue(sobol[1] == vec2f(0.5f, 0.5f));
+			Assert::IsTrue(sobol[2] == vec2f(0.25f, 0.75f));
+			Assert::IsTrue(sobol[3] == vec2f(0.75f, 0.25f));
+
+			// Every 2^k prefix of a scrambled sequence keeps one point per 1/2^k column.
+			std::vector<vec2f> scrambled(256);
+			sampleSobol2D(scrambled, 99);
+			// Seed first, then the start index, as in the random samplers.
+			std::vector<vec2f> tail(200);
+			sampleSobol2D(tail, 99, 56);
+			Assert::IsTrue(std::equal(tail.begin(), tail.end(), scrambled.begin() + 56));
+
+			bool columns[256] = { };
+			for (const vec2f& p : scrambled)
+			{
+				columns[int32_t(p.getX() * 256.0f)] = true;
+			}
+			for (bool column : columns)
+			{
+				Assert::IsTrue(column);
+			}
+
+			std::vector<vec3f> halton(4);
+			sampleHalton3D(halton);
+			Assert::IsTrue(halton[1] == vec3f(0.5f, 1.0f / 3.0f, 0.2f));
+			Assert::AreEqual(halton[3].getY(), 1.0f / 9.0f, 1e-7f);
+
+			std::vector<vec3f> warped(8);
+			warpToCosineHemisphere(std::span<const vec2f>(sobol), warped);
+			for (const vec3f& d : warped)
+			{
+				Assert::AreEqual(lengthSquare(d), 1.0f, 1e-5f);
+			}
+		}
+	};
+}
@@ -135,6 +135,58 @@ namespace vec
 		}
 	};
 
+	// A swizzle can only be named when every component it reads exists.
+	template<typename V> concept hasZyx = requires(const V& v) { v.zyx(); };
+	template<typename V> concept hasWx = requires(const V& v) { v.wx(); };
+
+	static_assert(!hasZyx<vec2f> && hasZyx<vec3f> && hasZyx<vec4f>);
+	static_assert(!hasWx<vec2f> && !hasWx<vec3f> && hasWx<vec4i>);
+
+	TEST_CLASS(vec_swizzle)
+	{
+	public:
+		TEST_METHOD(vec_swizzle_scalar)
+		{
+			const vec2f a(1.0f, 2.0f);
+			const vec3i b(1, 2, 3);
+			const vec4f c(1.0f, 2.0f, 3.0f, 4.0f);
+
+			Assert::IsTrue(a.yx() == vec2f(2.0f, 1.0f));
+			Assert::IsTrue(a.xyxy() == vec4f(1.0f, 2.0f, 1.0f, 2.0f));
+			Assert::IsTrue(a.yyy() == vec3f(2.0f));
+
+			Assert::IsTrue(b.zyx() == vec3i(3, 2, 1));
+			Assert::IsTrue(b.xz() == vec2i(1, 3));
+			Assert::IsTrue(b.xyzx() == vec4i(1, 2, 3, 1));
+
+			Assert::IsTrue(c.xyz() == vec3f(1.0f, 2.0f, 3.0f));
+			Assert::IsTrue(c.wzyx() == vec4f(4.0f, 3.0f, 2.0f, 1.0f));
+			Assert::IsTrue(c.zw() == vec2f(3.0f, 4.0f));
+
+			Assert::IsTrue(swizzle<2, 0, 1, 3>(c) == vec4f(3.0f, 1.0f, 2.0f, 4.0f));
+			Assert::IsTrue(swizzle<2, 0, 1, 3>(c) == c.zxyw());
+			Assert::IsTrue(swizzle<1, 1>(b) == vec2i(2, 2));
+			Assert::IsTrue(c.swizzle<3, 3, 0>() == vec3f(4.0f, 4.0f, 1.0f));
+		}
+
+		TEST_METHOD(vec_swizzle_simd)
+		{
+			const vfloat4 v(_mm_setr_ps(1.0f, 2.0f, 3.0f, 4.0f));
+
+			const vfloat4 zxyw = swizzle<2, 0, 1, 3>(v);
+			Assert::IsTrue(zxyw[0] == 3.0f && zxyw[1] == 1.0f && zxyw[2] == 2.0f && zxyw[3] == 4.0f);
+
+			const vfloat4 wwxx = swizzle<3, 3, 0, 0>(v);
+			Assert::IsTrue(wwxx[0] == 4.0f && wwxx[1] == 4.0f && wwxx[2] == 1.0f && wwxx[3] == 1.0f);
+
+#if EULER_HAS_VFLOAT8
+			const vfloat8 w(_mm256_setr_ps(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f));
+			const vfloat8 wzyx = swizzle<3, 2, 1, 0>(w);
+			Assert::IsTrue(wzyx[0] == 4.0f && wzyx[3] == 1.0f && wzyx[4] == 8.0f && wzyx[7] == 5.0f);
+#endif
+		}
+	};
+
 	TEST_CLASS(vec_compute_misc)
 	{
 	public: